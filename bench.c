@@ -0,0 +1,928 @@
+/*
+	性能测试驱动，每个用例对应一项优化，用来复现提交说明里的数字。
+	编译：gcc -O2 bench.c cJSON.c -lm -lpthread -o bench（对比紧凑布局时加 -std=c11 -DcJSON_COMPACT）
+	运行：./bench                 跑全部用例
+	      ./bench arena ...       只跑列出的用例
+	      ./bench arena a.json    参数中能打开的文件也加入输入语料
+	输入由固定种子生成，每次运行都相同；计时取5轮中最快一轮的平均值。计时用clock_gettime，需要POSIX环境。
+*/
+#define _POSIX_C_SOURCE 200112L
+#include <math.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "cJSON.h"
+
+/* 输入语料中的一篇文档 */
+typedef struct
+{
+	const char *name;
+	char *text; // 以'\0'结尾
+	size_t len;
+} doc;
+
+#define DOCS_MAX 32
+static doc docs[DOCS_MAX];
+static int ndocs;
+static const doc *cur; // 当前被测的文档
+
+/* 固定种子的xorshift，生成的输入每次相同 */
+static unsigned long long rnd_state = 88172645463325252ull;
+static unsigned rnd(void)
+{
+	rnd_state ^= rnd_state << 13;
+	rnd_state ^= rnd_state >> 7;
+	rnd_state ^= rnd_state << 17;
+	return (unsigned)rnd_state;
+}
+
+/* 生成输入用的可扩展字符串 */
+typedef struct
+{
+	char *buf;
+	size_t len, cap;
+} text;
+
+static void put(text *t, const char *fmt, ...)
+{
+	va_list ap;
+	int n;
+	for (;;)
+	{
+		va_start(ap, fmt);
+		n = vsnprintf(t->buf + t->len, t->cap - t->len, fmt, ap);
+		va_end(ap);
+		if (n >= 0 && t->len + n < t->cap)
+			break;
+		t->cap = t->cap ? t->cap * 2 : 4096;
+		if (!(t->buf = (char *)realloc(t->buf, t->cap)))
+			exit(1);
+	}
+	t->len += n;
+}
+
+static void add_doc(const char *name, char *s, size_t len)
+{
+	if (ndocs == DOCS_MAX)
+		return;
+	docs[ndocs].name = name, docs[ndocs].text = s, docs[ndocs].len = len;
+	ndocs++;
+}
+
+/* 日志/接口返回风格的记录数组：数字、短字符串、布尔值和小数组混在一起 */
+static void gen_records(int n)
+{
+	text t = {0};
+	int i;
+	put(&t, "[");
+	for (i = 0; i < n; i++)
+		put(&t, "%s{\"id\":%u,\"name\":\"user_%u\",\"email\":\"user%u@example.com\",\"active\":%s,\"score\":%u.%02u,"
+				"\"tags\":[\"t%u\",\"t%u\"],\"address\":{\"city\":\"city %u\",\"zip\":\"%05u\"},\"note\":null}",
+			i ? "," : "", 100000 + i, rnd() % 100000, rnd() % 100000, rnd() % 2 ? "true" : "false", rnd() % 1000, rnd() % 100,
+			rnd() % 50, rnd() % 50, rnd() % 1000, rnd() % 100000);
+	put(&t, "]");
+	add_doc("records", t.buf, t.len);
+}
+
+/* 长字符串值为主的日志：每条一段一两百个词的消息，偶尔夹着转义 */
+static void gen_strings(int n)
+{
+	static const char *words[] = {"request", "completed", "in", "ms", "user", "session", "GET", "/api/v1/items", "status", "200",
+								  "cache", "miss", "for", "key", "upstream", "timeout", "retrying", "with", "backoff", "\\n", "\\\"quoted\\\"", "caf\\u00e9"};
+	text t = {0};
+	int i, j, len;
+	put(&t, "[");
+	for (i = 0; i < n; i++)
+	{
+		put(&t, "%s{\"ts\":\"2024-05-01T12:00:%02u\",\"level\":\"info\",\"msg\":\"", i ? "," : "", rnd() % 60);
+		len = 50 + rnd() % 150;
+		for (j = 0; j < len; j++)
+		{
+			unsigned w = rnd() % 64;
+			put(&t, "%s ", words[w < 19 ? w : w < 61 ? w % 19 : w - 42]); // 转义只占约5%
+		}
+		put(&t, "\"}");
+	}
+	put(&t, "]");
+	add_doc("strings", t.buf, t.len);
+}
+
+/* GeoJSON的多边形边界：成对的经纬度小数，几乎全是数字和括号 */
+static void gen_coords(int n)
+{
+	text t = {0};
+	int i;
+	put(&t, "{\"type\":\"FeatureCollection\",\"features\":[{\"type\":\"Feature\",\"properties\":{\"name\":\"region\"},"
+			"\"geometry\":{\"type\":\"Polygon\",\"coordinates\":[[");
+	for (i = 0; i < n; i++)
+		put(&t, "%s[%.14f,%.14f]", i ? "," : "", -140 + (rnd() % 8000000) / 1e5, 42 + (rnd() % 4000000) / 1e5);
+	put(&t, "]]}}]}");
+	add_doc("coords", t.buf, t.len);
+}
+
+static double now(void)
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+/* 分5轮运行fn，每轮至少0.06秒、至少2次，返回最快一轮每次的平均毫秒数，减少其他进程的干扰 */
+static double timeit(void (*fn)(void))
+{
+	double start, t, best = 0;
+	int n, round;
+	fn(); // 预热
+	for (round = 0; round < 5; round++)
+	{
+		n = 0;
+		start = now();
+		do
+			fn(), n++;
+		while ((t = now() - start) < 0.06 || n < 2);
+		if (!round || t / n < best)
+			best = t / n;
+	}
+	return best * 1000;
+}
+
+/*
+	计数用的内存钩子：每块前面留16字节记大小，统计分配次数、当前和峰值占用（只算请求的字节，不含malloc每块自己的开销）。
+	mem_heap另按64位glibc的块大小估算实际占用：请求的字节加8字节块头，向上取整到16，至少32
+*/
+static size_t mem_calls, mem_now, mem_peak, mem_heap;
+#define HEAP_CHUNK(sz) ((sz) + 8 < 32 ? 32 : ((sz) + 8 + 15) / 16 * 16)
+static void *count_malloc(size_t sz)
+{
+	size_t *p = (size_t *)malloc(sz + 16);
+	if (!p)
+		return 0;
+	p[0] = sz;
+	mem_calls++;
+	mem_heap += HEAP_CHUNK(sz);
+	if ((mem_now += sz) > mem_peak)
+		mem_peak = mem_now;
+	return (char *)p + 16;
+}
+static void count_free(void *ptr)
+{
+	size_t *p;
+	if (!ptr)
+		return;
+	p = (size_t *)((char *)ptr - 16);
+	mem_now -= p[0];
+	mem_heap -= HEAP_CHUNK(p[0]);
+	free(p);
+}
+static void *count_realloc(void *ptr, size_t sz)
+{
+	size_t *p, old;
+	if (!ptr)
+		return count_malloc(sz);
+	p = (size_t *)((char *)ptr - 16);
+	old = p[0];
+	if (!(p = (size_t *)realloc(p, sz + 16)))
+		return 0;
+	p[0] = sz;
+	mem_calls++;
+	mem_heap = mem_heap - HEAP_CHUNK(old) + HEAP_CHUNK(sz);
+	if ((mem_now = mem_now - old + sz) > mem_peak)
+		mem_peak = mem_now;
+	return (char *)p + 16;
+}
+
+/* 装上计数钩子并清零计数 */
+static void count_start(void)
+{
+	cJSON_Hooks hooks;
+	memset(&hooks, 0, sizeof(hooks));
+	hooks.malloc_fn = count_malloc, hooks.free_fn = count_free;
+	cJSON_InitHooks(&hooks);
+	mem_calls = mem_now = mem_peak = mem_heap = 0;
+}
+
+/* 装上计数钩子跑一次fn，得到分配次数和峰值占用，之后恢复默认钩子 */
+static void measure(void (*fn)(void), size_t *calls, size_t *peak)
+{
+	count_start();
+	fn();
+	cJSON_InitHooks(0);
+	*calls = mem_calls, *peak = mem_peak;
+}
+
+/* 打印一行结果：用例、文档、做法、每次耗时和吞吐 */
+static void report(const char *cs, const char *how, double ms)
+{
+	printf("%-10s %-16s %-16s %9.3f ms %8.1f MB/s\n", cs, cur->name, how, ms, cur->len / 1e6 / (ms / 1000));
+}
+static void report_mem(const char *cs, const char *how, void (*fn)(void))
+{
+	size_t calls, peak;
+	measure(fn, &calls, &peak);
+	printf("%-10s %-16s %-16s %9lu allocs %9.2f MB peak\n", cs, cur->name, how, (unsigned long)calls, peak / 1e6);
+}
+
+/* user-001：逐节点malloc与arena，都包括解析和释放 */
+static void parse_malloc(void) { cJSON_Delete(cJSON_ParseWithLength(cur->text, cur->len)); }
+static void parse_arena(void) { cJSON_Delete(cJSON_ParseInArena(cur->text, 0)); }
+static void bench_arena(void)
+{
+	int i;
+	for (i = 0; i < ndocs; i++)
+	{
+		cur = &docs[i];
+		report("arena", "malloc per node", timeit(parse_malloc));
+		report("arena", "arena", timeit(parse_arena));
+		report_mem("arena", "malloc per node", parse_malloc);
+		report_mem("arena", "arena", parse_arena);
+	}
+}
+
+/* user-005：字符串扫描，解析并释放。与 -DcJSON_NO_SIMD 编译的结果对比可知SIMD扫描的收益 */
+static void bench_strings(void)
+{
+	int i;
+	for (i = 0; i < ndocs; i++)
+	{
+		cur = &docs[i];
+		report("strings", "parse+delete", timeit(parse_malloc));
+	}
+}
+
+/* 把tab缩进换成4个空格 */
+static char *tabs_to_spaces(const char *s)
+{
+	size_t n = 0;
+	const char *p;
+	char *out, *q;
+	for (p = s; *p; p++)
+		n += (*p == '\t') ? 4 : 1;
+	if (!(q = out = (char *)malloc(n + 1)))
+		exit(1);
+	for (p = s; *p; p++)
+		if (*p == '\t')
+			memcpy(q, "    ", 4), q += 4;
+		else
+			*q++ = *p;
+	*q = 0;
+	return out;
+}
+
+/* user-006：空白跳过，同一篇文档的紧凑、tab缩进和空格缩进三种写法分别解析并释放。与 -DcJSON_NO_SIMD 编译的结果对比 */
+static void bench_whitespace(void)
+{
+	static const char *style[3] = {"min", "tabs", "spaces"};
+	char name[3][64];
+	doc d[3];
+	cJSON *root;
+	int i, k;
+	for (i = 0; i < ndocs; i++)
+	{
+		if (!(root = cJSON_ParseWithLength(docs[i].text, docs[i].len)))
+			continue;
+		d[0].text = cJSON_PrintUnformatted(root);
+		d[1].text = cJSON_Print(root);
+		d[2].text = tabs_to_spaces(d[1].text);
+		cJSON_Delete(root);
+		for (k = 0; k < 3; k++)
+		{
+			sprintf(name[k], "%.50s/%s", docs[i].name, style[k]);
+			d[k].name = name[k], d[k].len = strlen(d[k].text);
+			cur = &d[k];
+			report("ws", "parse+delete", timeit(parse_malloc));
+			free(d[k].text);
+		}
+	}
+}
+
+/* user-007：数字数组的解析。对照组只做数字转换、不建树也不分配，是转换本身的耗时：逐个strtod，以及改动前逐位累加再乘pow(10,指数)的做法（快但舍入不正确） */
+static void scan_strtod(void)
+{
+	const char *p = cur->text;
+	char *end;
+	double sum = 0;
+	while (*p)
+		if (*p == '-' || (*p >= '0' && *p <= '9'))
+			sum += strtod(p, &end), p = end;
+		else
+			p++;
+	if (sum != sum)
+		exit(1);
+}
+static void scan_pow(void)
+{
+	const char *p = cur->text;
+	double sum = 0, n, sign, scale;
+	int sub, signsub;
+	while (*p)
+	{
+		if (*p != '-' && (*p < '0' || *p > '9'))
+		{
+			p++;
+			continue;
+		}
+		n = 0, sign = 1, scale = 0, sub = 0, signsub = 1;
+		if (*p == '-')
+			sign = -1, p++;
+		while (*p >= '0' && *p <= '9')
+			n = n * 10.0 + (*p++ - '0');
+		if (*p == '.')
+			for (p++; *p >= '0' && *p <= '9'; scale--)
+				n = n * 10.0 + (*p++ - '0');
+		if (*p == 'e' || *p == 'E')
+		{
+			p++;
+			if (*p == '+' || *p == '-')
+				signsub = (*p++ == '-') ? -1 : 1;
+			while (*p >= '0' && *p <= '9')
+				sub = sub * 10 + (*p++ - '0');
+		}
+		sum += sign * n * pow(10.0, scale + sub * signsub);
+	}
+	if (sum != sum)
+		exit(1);
+}
+/* 20万个数字的数组：kind为0是整数，1是两位小数，2是1e-10到1e10之间的17位有效数字 */
+static const char *num_kind[3] = {"ints", "decimals", "doubles"};
+static void gen_numbers(int kind, doc *d)
+{
+	text t = {0};
+	int i;
+	put(&t, "[");
+	for (i = 0; i < 200000; i++)
+	{
+		double x = (rnd() + 1.0) / 4294967296.0 * pow(10, (int)(rnd() % 21) - 10);
+		if (kind == 0)
+			put(&t, "%s%d", i ? "," : "", (int)(rnd() % 2000001) - 1000000);
+		else if (kind == 1)
+			put(&t, "%s%u.%02u", i ? "," : "", rnd() % 10000, rnd() % 100);
+		else
+			put(&t, "%s%.17g", i ? "," : "", x);
+	}
+	put(&t, "]");
+	d->name = num_kind[kind], d->text = t.buf, d->len = t.len;
+}
+static void bench_numbers(void)
+{
+	doc d;
+	int k;
+	for (k = 0; k < 3; k++)
+	{
+		gen_numbers(k, &d);
+		cur = &d;
+		report("numbers", "parse+delete", timeit(parse_malloc));
+		report("numbers", "strtod only", timeit(scan_strtod));
+		report("numbers", "pow() only", timeit(scan_pow));
+		free(d.text);
+	}
+}
+
+/* user-008：数字数组的输出。对照组用snprintf("%.17g")逐个格式化同样的数，不拼接也不分配 */
+static cJSON *num_tree;
+static void print_tree(void) { free(cJSON_PrintUnformatted(num_tree)); }
+static void print_libc(void)
+{
+	char buf[32];
+	cJSON *c;
+	size_t n = 0;
+	for (c = num_tree->child; c; c = c->next)
+		n += snprintf(buf, sizeof(buf), "%.17g", c->valuedouble);
+	if (!n)
+		exit(1);
+}
+static void bench_print_numbers(void)
+{
+	doc d;
+	int k;
+	for (k = 0; k < 3; k++)
+	{
+		gen_numbers(k, &d);
+		num_tree = cJSON_ParseWithLength(d.text, d.len);
+		cur = &d;
+		report("printnum", "PrintUnformatted", timeit(print_tree));
+		report("printnum", "snprintf %.17g", timeit(print_libc));
+		cJSON_Delete(num_tree);
+		free(d.text);
+	}
+}
+
+/* user-010：解析后整棵树的内存占用。与 -DcJSON_COMPACT 编译的结果对比可知紧凑布局的收益 */
+static size_t count_nodes(const cJSON *c)
+{
+	size_t n = 0;
+	for (; c; c = c->next)
+		n += 1 + count_nodes(c->child);
+	return n;
+}
+static void report_tree(const char *how, cJSON *root)
+{
+	size_t nodes = count_nodes(root);
+	printf("%-10s %-16s %-16s %9lu nodes %6.1f B/node %6.1f B/node heap %8.2f MB heap\n", "memory", cur->name, how,
+		   (unsigned long)nodes, (double)mem_now / nodes, (double)mem_heap / nodes, mem_heap / 1e6);
+}
+static void bench_memory(void)
+{
+	cJSON *root;
+	int i;
+	printf("%-10s sizeof(cJSON) = %lu\n", "memory", (unsigned long)sizeof(cJSON));
+	for (i = 0; i < ndocs; i++)
+	{
+		cur = &docs[i];
+		count_start();
+		root = cJSON_ParseWithLength(cur->text, cur->len);
+		report_tree("malloc per node", root);
+		cJSON_Delete(root);
+		root = cJSON_ParseInArena(cur->text, 0);
+		report_tree("arena", root);
+		cJSON_Delete(root);
+		cJSON_InitHooks(0);
+	}
+}
+
+/* user-011：多个线程各自解析整份语料，看总吞吐是否随线程数增长。单核机器上各行应当持平 */
+#define SCALE_ROUNDS 5
+static void *scale_worker(void *arg)
+{
+	cJSON_Error e;
+	int r, i;
+	(void)arg;
+	for (r = 0; r < SCALE_ROUNDS; r++)
+		for (i = 0; i < ndocs; i++)
+			cJSON_Delete(cJSON_ParseWithError(docs[i].text, 0, 1, &e));
+	return 0;
+}
+static void bench_threads(void)
+{
+	static const int counts[] = {1, 2, 4, 8};
+	pthread_t th[8];
+	char how[16];
+	size_t bytes = 0;
+	double start, t;
+	int k, i;
+	for (i = 0; i < ndocs; i++)
+		bytes += docs[i].len;
+	scale_worker(0); // 预热
+	for (k = 0; k < 4; k++)
+	{
+		start = now();
+		for (i = 0; i < counts[k]; i++)
+			pthread_create(&th[i], 0, scale_worker, 0);
+		for (i = 0; i < counts[k]; i++)
+			pthread_join(th[i], 0);
+		t = now() - start;
+		sprintf(how, "%d threads", counts[k]);
+		printf("%-10s %-16s %-16s %9.3f ms %8.1f MB/s\n", "threads", "all docs", how, t * 1000, bytes * SCALE_ROUNDS * counts[k] / 1e6 / t);
+	}
+}
+
+/* user-013：就地解析与复制字符串的解析。就地解析会改写输入，每次先把文档复制到可写的缓冲区里，复制也计入耗时 */
+static char *scratch;
+static void parse_insitu(void)
+{
+	memcpy(scratch, cur->text, cur->len + 1);
+	cJSON_Delete(cJSON_ParseInSitu(scratch, cur->len));
+}
+static void bench_insitu(void)
+{
+	int i;
+	for (i = 0; i < ndocs; i++)
+	{
+		cur = &docs[i];
+		if (!(scratch = (char *)malloc(cur->len + 1)))
+			exit(1);
+		report("insitu", "copying", timeit(parse_malloc));
+		report("insitu", "in-situ", timeit(parse_insitu));
+		report_mem("insitu", "copying", parse_malloc);
+		report_mem("insitu", "in-situ", parse_insitu);
+		free(scratch);
+	}
+}
+
+/* user-016：SAX与建树后遍历。任务是对全部数字求和并统计字符串个数；另测找到"id"为110000的记录的"email"就中止的解析（只在records里有，位于中间） */
+typedef struct
+{
+	double sum;
+	size_t strings;
+	int key;   // 上一个键名：1是"id"，2是"email"，0是其他
+	int found; // 已经读到要找的id
+} sax_totals;
+static int sax_number(void *ctx, double d, long long i)
+{
+	sax_totals *t = (sax_totals *)ctx;
+	t->sum += d;
+	t->found |= (t->key == 1 && i == 110000);
+	return 1;
+}
+static int sax_string(void *ctx, const char *s)
+{
+	sax_totals *t = (sax_totals *)ctx;
+	(void)s;
+	t->strings++;
+	return !(t->found && t->key == 2); // 读到要找的email就中止
+}
+static int sax_key(void *ctx, const char *key)
+{
+	((sax_totals *)ctx)->key = !strcmp(key, "id") ? 1 : !strcmp(key, "email") ? 2 : 0;
+	return 1;
+}
+static void walk_totals(const cJSON *c, sax_totals *t)
+{
+	for (; c; c = c->next)
+	{
+		if (c->type == cJSON_Number)
+			t->sum += c->valuedouble;
+		else if (c->type == cJSON_String)
+			t->strings++;
+		walk_totals(c->child, t);
+	}
+}
+static void totals_tree(void)
+{
+	sax_totals t = {0, 0, 0, 0};
+	cJSON *root = cJSON_ParseWithLength(cur->text, cur->len);
+	walk_totals(root, &t);
+	cJSON_Delete(root);
+	if (!t.strings)
+		exit(1);
+}
+static void totals_sax(void)
+{
+	static const cJSON_Sax sax = {0, 0, 0, 0, 0, sax_string, sax_number, 0, 0};
+	sax_totals t = {0, 0, 0, 0};
+	if (!cJSON_ParseSax(cur->text, cur->len, 1, &sax, &t, 0) || !t.strings)
+		exit(1);
+}
+static void find_email(void)
+{
+	static const cJSON_Sax sax = {0, 0, 0, 0, sax_key, sax_string, sax_number, 0, 0};
+	sax_totals t = {0, 0, 0, 0};
+	cJSON_ParseSax(cur->text, cur->len, 1, &sax, &t, 0);
+}
+static void bench_sax(void)
+{
+	int i;
+	for (i = 0; i < ndocs; i++)
+	{
+		cur = &docs[i];
+		report("sax", "parse+walk+del", timeit(totals_tree));
+		report("sax", "SAX", timeit(totals_sax));
+		report("sax", "SAX find+abort", timeit(find_email));
+	}
+}
+
+/* user-017：JSON Lines批量解析，用1到8个线程解析同一批记录。对照组是在一个线程上逐行调用cJSON_ParseWithLength、解析完就释放；
+   ParseLinesEach同样在回调里释放，ParseLines则要留下全部结果，最后一起释放 */
+static int lines_threads;
+static void lines_loop(void)
+{
+	const char *p = cur->text, *end = cur->text + cur->len, *nl;
+	for (; p < end; p = nl + 1)
+	{
+		if (!(nl = (const char *)memchr(p, '\n', end - p)))
+			nl = end;
+		cJSON_Delete(cJSON_ParseWithLength(p, nl - p));
+	}
+}
+static int lines_drop(void *ctx, size_t index, cJSON *item, const cJSON_Error *error)
+{
+	(void)ctx, (void)index, (void)error;
+	cJSON_Delete(item);
+	return 1;
+}
+static void lines_each(void)
+{
+	if (!cJSON_ParseLinesEach(cur->text, cur->len, lines_threads, lines_drop, 0))
+		exit(1);
+}
+static void lines_batch(void)
+{
+	size_t n;
+	cJSON **items = cJSON_ParseLines(cur->text, cur->len, lines_threads, &n);
+	if (!items)
+		exit(1);
+	cJSON_DeleteLines(items, n);
+}
+static void bench_lines(void)
+{
+	static const int counts[] = {1, 2, 4, 8};
+	char how[16];
+	text t = {0};
+	doc d;
+	cJSON *root, *c;
+	char *s;
+	int i, k;
+	for (i = 0; i < ndocs; i++) // 每篇顶层是数组的文档，一个元素一行
+	{
+		if (!(root = cJSON_ParseWithLength(docs[i].text, docs[i].len)))
+			continue;
+		if (root->type == cJSON_Array)
+			for (c = root->child; c; c = c->next)
+			{
+				s = cJSON_PrintUnformatted(c);
+				put(&t, "%s\n", s);
+				free(s);
+			}
+		cJSON_Delete(root);
+	}
+	if (!t.len)
+		return;
+	d.name = "all docs", d.text = t.buf, d.len = t.len;
+	cur = &d;
+	report("lines", "line by line", timeit(lines_loop));
+	for (k = 0; k < 4; k++)
+	{
+		lines_threads = counts[k];
+		sprintf(how, "Each %d thr", counts[k]);
+		report("lines", how, timeit(lines_each));
+		sprintf(how, "ordered %d thr", counts[k]);
+		report("lines", how, timeit(lines_batch));
+	}
+	free(t.buf);
+}
+
+/* user-019：两阶段引擎与默认引擎，解析同一篇文档并释放 */
+static void parse_indexed(void) { cJSON_Delete(cJSON_ParseIndexed(cur->text, cur->len)); }
+static void bench_engine(void)
+{
+	int i;
+	for (i = 0; i < ndocs; i++)
+	{
+		cur = &docs[i];
+		report("engine", "default", timeit(parse_malloc));
+		report("engine", "indexed", timeit(parse_indexed));
+	}
+}
+
+/* user-021：输出整棵树。PrintBuffered分别给一个小的初始大小（要多次扩容）和正好够用的大小；PrintPreallocated写进调用者的缓冲区，不分配 */
+static cJSON *print_root;
+static char *print_out;
+static size_t print_len;
+static void print_unformatted(void) { free(cJSON_PrintUnformatted(print_root)); }
+static void print_formatted(void) { free(cJSON_Print(print_root)); }
+static void print_buffered_small(void) { free(cJSON_PrintBuffered(print_root, 256, 0)); }
+static void print_buffered_exact(void) { free(cJSON_PrintBuffered(print_root, (int)print_len, 0)); }
+static void print_prealloc(void)
+{
+	if (!cJSON_PrintPreallocated(print_root, print_out, print_len, 0))
+		exit(1);
+}
+static void bench_print(void)
+{
+	int i;
+	for (i = 0; i < ndocs; i++)
+	{
+		cur = &docs[i];
+		if (!(print_root = cJSON_ParseWithLength(cur->text, cur->len)))
+			continue;
+		print_len = cJSON_PrintedLength(print_root, 0) + 1;
+		if (!(print_out = (char *)malloc(print_len)))
+			exit(1);
+		report("print", "Print", timeit(print_formatted));
+		report("print", "PrintUnformatted", timeit(print_unformatted));
+		report("print", "Buffered 256", timeit(print_buffered_small));
+		report("print", "Buffered exact", timeit(print_buffered_exact));
+		report("print", "Preallocated", timeit(print_prealloc));
+		free(print_out);
+		cJSON_Delete(print_root);
+	}
+}
+
+/*
+	user-024：输出缓冲区的扩容。libc是默认钩子；hooks只装了malloc和free，没有realloc，Print先估算长度，PrintBuffered每次扩容都分配、复制、释放；
+	hooks+realloc另用cJSON_InitReallocHook装上realloc。后两种都走计数钩子，多出的耗时里有计数的开销，互相比较时是公平的
+*/
+static void grow_unformatted(void) { count_free(cJSON_PrintUnformatted(print_root)); }
+static void grow_buffered(void) { count_free(cJSON_PrintBuffered(print_root, 256, 0)); }
+static void grow_run(const char *how, int mode, const char *fn_name, void (*fn)(void))
+{
+	char label[32];
+	double ms;
+	if (mode)
+		count_start();
+	if (mode == 2)
+		cJSON_InitReallocHook(count_realloc);
+	ms = timeit(fn);
+	mem_calls = mem_now = mem_peak = 0;
+	if (mode)
+		fn();
+	cJSON_InitHooks(0);
+	sprintf(label, "%s %s", fn_name, how);
+	if (mode)
+		printf("%-10s %-16s %-26s %9.3f ms %6lu allocs %9.2f MB peak\n", "grow", cur->name, label, ms, (unsigned long)mem_calls, mem_peak / 1e6);
+	else
+		printf("%-10s %-16s %-26s %9.3f ms\n", "grow", cur->name, label, ms);
+}
+static void bench_grow(void)
+{
+	static const char *how[3] = {"libc", "hooks", "hooks+realloc"};
+	int i, mode;
+	for (i = 0; i < ndocs; i++)
+	{
+		cur = &docs[i];
+		if (!(print_root = cJSON_ParseWithLength(cur->text, cur->len)))
+			continue;
+		for (mode = 0; mode < 3; mode++)
+			grow_run(how[mode], mode, "Unformatted", mode ? grow_unformatted : print_unformatted);
+		for (mode = 0; mode < 3; mode++)
+			grow_run(how[mode], mode, "Buffered 256", mode ? grow_buffered : print_buffered_small);
+		cJSON_Delete(print_root);
+	}
+}
+
+/* user-022：嵌套深度不同、叶子总数相同的文档的输出。每层一个对象，放一段数字数组和下一层；耗时应当只随输出字节数增长，与深度无关 */
+static void bench_deep(void)
+{
+	static const int depths[] = {1, 10, 100, 900};
+	char name[32];
+	cJSON *level, *leaves, *parent;
+	doc d;
+	int k, i, j;
+	for (k = 0; k < 4; k++)
+	{
+		print_root = parent = cJSON_CreateObject();
+		for (i = 0; i < depths[k]; i++)
+		{
+			leaves = cJSON_CreateArray();
+			for (j = 0; j < 100000 / depths[k]; j++)
+				cJSON_AddItemToArray(leaves, cJSON_CreateNumber(j));
+			cJSON_AddItemToObject(parent, "values", leaves);
+			level = cJSON_CreateObject();
+			cJSON_AddItemToObject(parent, "next", level);
+			parent = level;
+		}
+		sprintf(name, "depth %d", depths[k]);
+		d.name = name, d.text = cJSON_PrintUnformatted(print_root), d.len = strlen(d.text);
+		cur = &d;
+		report("deep", "PrintUnformatted", timeit(print_unformatted));
+		free(d.text);
+		d.text = cJSON_Print(print_root), d.len = strlen(d.text);
+		report("deep", "Print", timeit(print_formatted));
+		free(d.text);
+		cJSON_Delete(print_root);
+	}
+}
+
+/*
+	user-004：用公开接口逐行构建行数组，每行一个带4个成员的对象，包括释放。追加按尾指针是O(1)，每行耗时应当与行数无关。
+	walk一列清掉首成员的prev，让AddItemToArray退回从头遍历找尾，即改动前的O(n^2)做法，只跑到12500行
+*/
+static int build_n, build_walk;
+static void build_rows(void)
+{
+	cJSON *rows = cJSON_CreateArray(), *row;
+	char name[24];
+	int i;
+	for (i = 0; i < build_n; i++)
+	{
+		row = cJSON_CreateObject();
+		sprintf(name, "user%d", i);
+		cJSON_AddItemToObject(row, "id", cJSON_CreateNumber(i));
+		cJSON_AddItemToObject(row, "name", cJSON_CreateString(name));
+		cJSON_AddItemToObject(row, "score", cJSON_CreateNumber(i * 0.5));
+		cJSON_AddItemToObject(row, "active", cJSON_CreateTrue());
+		if (build_walk && rows->child)
+			rows->child->prev = 0;
+		cJSON_AddItemToArray(rows, row);
+	}
+	if (cJSON_GetArraySize(rows) != build_n)
+		exit(1);
+	cJSON_Delete(rows);
+}
+static void bench_build(void)
+{
+	static const int sizes[] = {6250, 12500, 25000, 50000, 100000, 200000};
+	double append, walk;
+	int k;
+	printf("%-10s %8s %14s %14s %12s\n", "build", "rows", "append ns/row", "walk ns/row", "append ms");
+	for (k = 0; k < (int)(sizeof(sizes) / sizeof(sizes[0])); k++)
+	{
+		build_n = sizes[k];
+		build_walk = 0;
+		append = timeit(build_rows);
+		if (build_n <= 12500)
+		{
+			build_walk = 1;
+			walk = timeit(build_rows);
+			printf("%-10s %8d %14.1f %14.1f %12.3f\n", "build", build_n, append * 1e6 / build_n, walk * 1e6 / build_n, append);
+		}
+		else
+			printf("%-10s %8d %14.1f %14s %12.3f\n", "build", build_n, append * 1e6 / build_n, "-", append);
+	}
+}
+
+/* user-002：对象按键名查找，链表扫描与哈希索引的交叉点 */
+static cJSON *wide;		  // 被查找的对象
+static char (*wide_keys)[16]; // 它的全部键名
+static int wide_n;
+static void lookup_nocase(void)
+{
+	int i;
+	for (i = 0; i < wide_n; i++)
+		if (!cJSON_GetObjectItem(wide, wide_keys[i]))
+			exit(1);
+}
+static void lookup_case(void)
+{
+	int i;
+	for (i = 0; i < wide_n; i++)
+		if (!cJSON_GetObjectItemCaseSensitive(wide, wide_keys[i]))
+			exit(1);
+}
+static void bench_lookup(void)
+{
+	static const int widths[] = {2, 4, 8, 16, 32, 64, 256, 1024, 4096};
+	double scan, hash, scan_cs, hash_cs;
+	int w, i;
+	printf("%-10s %8s %14s %14s %14s %14s\n", "lookup", "keys", "scan ns", "index ns", "scan(CS) ns", "index(CS) ns");
+	for (w = 0; w < (int)(sizeof(widths) / sizeof(widths[0])); w++)
+	{
+		wide_n = widths[w];
+		wide = cJSON_CreateObject();
+		wide_keys = (char (*)[16])malloc(wide_n * sizeof(*wide_keys));
+		for (i = 0; i < wide_n; i++)
+		{
+			sprintf(wide_keys[i], "feature_%d", i);
+			cJSON_AddItemToObject(wide, wide_keys[i], cJSON_CreateNumber(i));
+		}
+		scan = timeit(lookup_nocase), scan_cs = timeit(lookup_case);
+		cJSON_BuildIndex(wide, 0);
+		hash = timeit(lookup_nocase), hash_cs = timeit(lookup_case);
+		printf("%-10s %8d %14.1f %14.1f %14.1f %14.1f\n", "lookup", wide_n, scan * 1e6 / wide_n, hash * 1e6 / wide_n, scan_cs * 1e6 / wide_n, hash_cs * 1e6 / wide_n);
+		cJSON_Delete(wide);
+		free(wide_keys);
+	}
+}
+
+static const struct
+{
+	const char *name;
+	void (*run)(void);
+} cases[] = {
+	{"arena", bench_arena},
+	{"build", bench_build},
+	{"deep", bench_deep},
+	{"engine", bench_engine},
+	{"grow", bench_grow},
+	{"insitu", bench_insitu},
+	{"lines", bench_lines},
+	{"lookup", bench_lookup},
+	{"memory", bench_memory},
+	{"numbers", bench_numbers},
+	{"print", bench_print},
+	{"printnum", bench_print_numbers},
+	{"sax", bench_sax},
+	{"strings", bench_strings},
+	{"threads", bench_threads},
+	{"ws", bench_whitespace},
+};
+#define NCASES ((int)(sizeof(cases) / sizeof(cases[0])))
+
+/* 读入命令行给出的文件，打不开时返回0 */
+static int load_file(const char *path)
+{
+	FILE *f = fopen(path, "rb");
+	long len;
+	char *s;
+	if (!f)
+		return 0;
+	fseek(f, 0, SEEK_END);
+	len = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	if (len < 0 || !(s = (char *)malloc(len + 1)) || fread(s, 1, len, f) != (size_t)len)
+		exit(1);
+	fclose(f);
+	s[len] = 0;
+	add_doc(path, s, len);
+	return 1;
+}
+
+int main(int argc, char **argv)
+{
+	int i, j, any = 0;
+	gen_records(20000);
+	gen_strings(5000);
+	gen_coords(50000);
+	for (i = 1; i < argc; i++)
+	{
+		for (j = 0; j < NCASES && strcmp(argv[i], cases[j].name); j++)
+			;
+		if (j < NCASES)
+			any = 1;
+		else if (!load_file(argv[i]))
+		{
+			fprintf(stderr, "unknown case or file: %s\n", argv[i]);
+			return 1;
+		}
+	}
+	for (j = 0; j < NCASES; j++)
+	{
+		for (i = 1; any && i < argc && strcmp(argv[i], cases[j].name); i++)
+			;
+		if (!any || i < argc)
+			cases[j].run();
+	}
+	return 0;
+}
@@ -8,9 +8,43 @@
 #include <float.h>
 #include <limits.h>
 #include <ctype.h>
+#include <errno.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 #include "cJSON.h"
 
-static const char *ep; // 错误指针
+/* x86上用SSE2/AVX2成段扫描字符串，定义cJSON_NO_SIMD可关闭 */
+#if !defined(cJSON_NO_SIMD) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#define cJSON_USE_SSE2
+#include <stdint.h>
+#include <emmintrin.h>
+#if (defined(__clang__) || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#define cJSON_USE_AVX2 // AVX2在运行时检测CPU后再用
+#include <immintrin.h>
+#endif
+#endif
+
+/* 多线程批量解析用pthread，定义cJSON_NO_THREADS可关闭，cJSON_ParseLines随之退化为在调用线程上逐条解析 */
+#if !defined(cJSON_NO_THREADS) && !defined(_WIN32)
+#define cJSON_USE_THREADS
+#include <pthread.h>
+#endif
+
+/* 线程局部存储，让旧的cJSON_GetErrorPtr在多线程下也互不干扰 */
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_THREADS__)
+#define cJSON_THREAD_LOCAL _Thread_local
+#elif defined(__GNUC__)
+#define cJSON_THREAD_LOCAL __thread
+#elif defined(_MSC_VER)
+#define cJSON_THREAD_LOCAL __declspec(thread)
+#else
+#define cJSON_THREAD_LOCAL // 不支持线程局部存储时退化为普通全局变量
+#endif
+
+static cJSON_THREAD_LOCAL const char *ep; // 错误指针，只由旧接口写入，解析过程本身不读写任何共享状态
 
 const char *cJSON_GetErrorPtr(void) { return ep; } // 获取错误指针，该指针指向出现错误的第一个字符
 
@@ -30,15 +64,28 @@ static int cJSON_strcasecmp(const char *s1, const char *s2)
 // 默认使用malloc和free作为内存分配和释放函数。
 static void *(*cJSON_malloc)(size_t sz) = malloc;
 static void (*cJSON_free)(void *ptr) = free;
+// 为空时没有可用的realloc，缓冲区扩容退回分配、复制、释放
+static void *(*cJSON_realloc)(void *ptr, size_t sz) = realloc;
+
+/* 内存操作都带一个分配器上下文，为空时走cJSON_InitHooks设置的全局函数 */
+static void *mem_malloc(const cJSON_Allocator *a, size_t sz) { return a ? a->malloc_fn(a->ctx, sz) : cJSON_malloc(sz); }
+static int mem_can_realloc(const cJSON_Allocator *a) { return a ? a->realloc_fn != 0 : cJSON_realloc != 0; }
+static void mem_free(const cJSON_Allocator *a, void *ptr)
+{
+	if (a)
+		a->free_fn(a->ctx, ptr);
+	else
+		cJSON_free(ptr);
+}
 
 /* 手动分配内存渲染字符串 */
-static char *cJSON_strdup(const char *str)
+static char *cJSON_strdup(const char *str, const cJSON_Allocator *a)
 {
 	size_t len; // 记录字符串长度
 	char *copy; // 存储复制后的字符串
 
 	len = strlen(str) + 1; // 加上结束字符'\0'
-	if (!(copy = (char *)cJSON_malloc(len)))
+	if (!(copy = (char *)mem_malloc(a, len)))
 		return 0;			// 分配失败
 	memcpy(copy, str, len); // 复制字符串
 	return copy;
@@ -50,204 +97,1027 @@ void cJSON_InitHooks(cJSON_Hooks *hooks) // mark:1
 	{ /* Reset hooks */
 		cJSON_malloc = malloc;
 		cJSON_free = free;
+		cJSON_realloc = realloc;
 		return;
 	}
 
 	cJSON_malloc = (hooks->malloc_fn) ? hooks->malloc_fn : malloc;
 	cJSON_free = (hooks->free_fn) ? hooks->free_fn : free;
+	cJSON_realloc = (cJSON_malloc == malloc && cJSON_free == free) ? realloc : 0; // libc的realloc只能配libc的malloc和free
+}
+
+void cJSON_InitReallocHook(void *(*realloc_fn)(void *ptr, size_t sz))
+{
+	cJSON_realloc = realloc_fn;
+}
+
+/* 把size_old字节的ptr扩大到size字节并保留原有内容，有realloc时能原地扩大就不复制。失败返回0，ptr不变 */
+static void *cJSON_grow(const cJSON_Allocator *a, void *ptr, size_t size_old, size_t size)
+{
+	void *mem;
+	if (mem_can_realloc(a))
+		return a ? a->realloc_fn(a->ctx, ptr, size) : cJSON_realloc(ptr, size);
+	if (!(mem = mem_malloc(a, size)))
+		return 0;
+	if (ptr)
+	{
+		memcpy(mem, ptr, size_old);
+		mem_free(a, ptr);
+	}
+	return mem;
 }
 
 /* JSON结构内部构造器 */
-static cJSON *cJSON_New_Item(void)
+static cJSON *cJSON_New_Item(const cJSON_Allocator *a)
 {
-	cJSON *node = (cJSON *)cJSON_malloc(sizeof(cJSON)); // 本质是用malloc函数分配内存。
+	cJSON *node = (cJSON *)mem_malloc(a, sizeof(cJSON)); // 本质是用malloc函数分配内存。
 	if (node)
 		memset(node, 0, sizeof(cJSON)); // node初始化为0，初始化新分配的内存空间。
 	return node;
 }
 
-/* 删除一个JSON结构体对象 */
-void cJSON_Delete(cJSON *c)
+/* arena 内存块头，所有块用单链表串起来，表头是当前正在切分的块 */
+typedef struct cJSON_ArenaChunk
+{
+	struct cJSON_ArenaChunk *next;
+} cJSON_ArenaChunk;
+
+struct cJSON_Arena
+{
+	cJSON_ArenaChunk *chunks; // 内存块链表
+	char *cur;				  // 当前块中下一个可用字节
+	size_t left;			  // 当前块剩余字节数
+	size_t chunk_size;		  // 新建块的大小
+};
+
+#define cJSON_ARENA_ALIGN(n) (((n) + sizeof(double) - 1) & ~(sizeof(double) - 1)) // 按double对齐，保证节点中的valuedouble可用
+#define cJSON_ARENA_HEADER cJSON_ARENA_ALIGN(sizeof(cJSON_ArenaChunk))				// 块头占用的字节数
+#define cJSON_ARENA_DEFAULT_CHUNK 65536												// 默认块大小
+#define cJSON_ARENA_MIN_CHUNK 1024													// 最小块大小，至少要放下arena自身和根节点
+
+/* 拥有arena的根节点紧跟在arena结构体之后，由根节点反推arena */
+#define cJSON_ArenaOf(root) ((cJSON_Arena *)((char *)(root) - cJSON_ARENA_ALIGN(sizeof(cJSON_Arena))))
+
+cJSON_Arena *cJSON_CreateArena(size_t chunk_size)
+{
+	cJSON_ArenaChunk *chunk;
+	cJSON_Arena *arena;
+
+	if (!chunk_size)
+		chunk_size = cJSON_ARENA_DEFAULT_CHUNK;
+	else if (chunk_size < cJSON_ARENA_MIN_CHUNK)
+		chunk_size = cJSON_ARENA_MIN_CHUNK;
+	chunk = (cJSON_ArenaChunk *)cJSON_malloc(cJSON_ARENA_HEADER + chunk_size);
+	if (!chunk)
+		return 0;
+	chunk->next = 0;
+	arena = (cJSON_Arena *)((char *)chunk + cJSON_ARENA_HEADER); // arena自身放在第一个块的开头，不再单独分配
+	arena->chunks = chunk;
+	arena->chunk_size = chunk_size;
+	arena->cur = (char *)arena + cJSON_ARENA_ALIGN(sizeof(cJSON_Arena));
+	arena->left = chunk_size - cJSON_ARENA_ALIGN(sizeof(cJSON_Arena));
+	return arena;
+}
+
+void cJSON_DeleteArena(cJSON_Arena *arena)
+{
+	cJSON_ArenaChunk *chunk, *next;
+	if (!arena)
+		return;
+	chunk = arena->chunks; // arena自身在最后一个块里，释放过程中不能再访问arena
+	while (chunk)
+	{
+		next = chunk->next;
+		cJSON_free(chunk);
+		chunk = next;
+	}
+}
+
+/* 从arena中切出sz字节，当前块不够时再申请新块 */
+static void *cJSON_ArenaAlloc(cJSON_Arena *arena, size_t sz)
+{
+	cJSON_ArenaChunk *chunk;
+	char *mem;
+
+	sz = cJSON_ARENA_ALIGN(sz);
+	if (sz > arena->left)
+	{
+		if (sz > arena->chunk_size) // 超大的请求单独成块，挂在当前块之后，当前块剩余空间继续使用
+		{
+			chunk = (cJSON_ArenaChunk *)cJSON_malloc(cJSON_ARENA_HEADER + sz);
+			if (!chunk)
+				return 0;
+			chunk->next = arena->chunks->next;
+			arena->chunks->next = chunk;
+			return (char *)chunk + cJSON_ARENA_HEADER;
+		}
+		chunk = (cJSON_ArenaChunk *)cJSON_malloc(cJSON_ARENA_HEADER + arena->chunk_size);
+		if (!chunk)
+			return 0;
+		chunk->next = arena->chunks;
+		arena->chunks = chunk;
+		arena->cur = (char *)chunk + cJSON_ARENA_HEADER;
+		arena->left = arena->chunk_size;
+	}
+	mem = arena->cur;
+	arena->cur += sz;
+	arena->left -= sz;
+	return mem;
+}
+
+/* 对象键名哈希表的槽位 */
+typedef struct
+{
+	unsigned hash; // 键名忽略大小写后的哈希值
+	cJSON *item;   // 为空表示空槽
+} cJSON_IndexSlot;
+
+/* 数组/对象的内部记录，挂在节点的internal上：用非全局分配器建的容器一建好就有，未展开的容器和建索引时按需创建 */
+struct cJSON_Internal
+{
+	cJSON_IndexSlot *slots; // 键名的线性探测开放寻址哈希表，未建立时为空
+	int size;				// 槽数，2的幂
+	int count;				// 已占用的槽数
+	int dup;				// 出现忽略大小写的重复键时置1，查找退化为线性扫描，保证返回链表中第一个匹配项
+
+	cJSON **items; // 按链表顺序排列的成员指针向量，未建立时为空
+	int length;	   // 成员数，即缓存的数组大小
+	int capacity;  // items的容量
+	const cJSON_Allocator *alloc; // 建这个容器用的分配器（为空是全局分配器），增删改和建索引都按它分配和释放，记录本身也从它分配
+
+	const char *span; // 未展开的容器在输入中的范围，只读，不会写回输入；懒解析只用全局分配器
+	size_t spanlen;
+};
+
+/*
+	记录只挂在数组和对象上，不占用valuestring、valueint64这些公开字段，用户改写它们不会破坏索引和分配器。
+	引用节点不带记录，和其余非容器节点一样按所在容器的分配器释放
+*/
+#define cJSON_CONTAINER(item) (((item)->type & 255) == cJSON_Array || ((item)->type & 255) == cJSON_Object)
+#define cJSON_INDEX(item) ((item)->internal)
+#define cJSON_ALLOC(item) ((item)->internal ? (item)->internal->alloc : (const cJSON_Allocator *)0)
+#define cJSON_VALUESTRING(item) ((((item)->type & 255) == cJSON_String) ? (item)->valuestring : (char *)0)
+
+/* 为容器新建一条空记录，从alloc分配。内存不足时返回0 */
+static struct cJSON_Internal *internal_new(cJSON *item, const cJSON_Allocator *alloc)
 {
-	cJSON *next; // 用于暂存下一个节点指针。
-	while (c)	 // 对象非空
+	struct cJSON_Internal *rec = (struct cJSON_Internal *)mem_malloc(alloc, sizeof(struct cJSON_Internal));
+	if (rec)
 	{
-		next = c->next; // 暂存子节点指针。
+		memset(rec, 0, sizeof(struct cJSON_Internal));
+		rec->alloc = alloc;
+		item->internal = rec;
+	}
+	return rec;
+}
+
+/* 释放容器的内部记录和其中的索引 */
+static void cJSON_FreeIndex(struct cJSON_Internal *index)
+{
+	if (!index)
+		return;
+	mem_free(index->alloc, index->slots);
+	mem_free(index->alloc, index->items);
+	mem_free(index->alloc, index);
+}
 
+/*
+	删除一个JSON结构体对象。子节点不递归删除：进入子节点链表前把当前节点用prev（删除时已经用不到）串进一个栈，子节点都删完后回到它，调用栈的用量与嵌套深度无关。
+	容器按自己记下的分配器释放，其余节点（包括引用）按所在容器的，最外层的非容器节点才用alloc
+*/
+void cJSON_DeleteWithAllocator(cJSON *c, const cJSON_Allocator *alloc)
+{
+	cJSON *next;	// 用于暂存下一个节点指针。
+	cJSON *up = 0;	// 子节点还没删完的祖先节点，用prev串起来
+	const cJSON_Allocator *a; // 当前节点的分配器
+	while (c || up) // 对象非空，或者还有没删完的上层
+	{
+		if (!c) // 一层删完了，回到上一层删除容器本身
+		{
+			c = up;
+			up = up->prev;
+		}
 		/*
 		这里用位运算比直接判断 c->type == cJSON_IsReference 更快，
 		cJSON_IsReference和cJSON_StringIsConst都是较大的二进制数，
 		这里按位与操作相当于判断最高位是否是1。常规类型都是较小二进制数。
 		*/
-		// 如果当前节点不是引用类型并且有子节点，则递归释放子节点占用的内存
-		if (!(c->type & cJSON_IsReference) && c->child)
-			cJSON_Delete(c->child);
-		// 如果当前节点不是引用类型并且值字符串不为空，则释放值字符串占用的内存
-		if (!(c->type & cJSON_IsReference) && c->valuestring)
-			cJSON_free(c->valuestring);
+		// 如果当前节点不是引用类型并且有子节点，先删除子节点，删完后再回到当前节点
+		else if (!(c->type & cJSON_IsReference) && c->child)
+		{
+			next = c->child;
+			c->child = 0;
+			c->prev = up, up = c;
+			c = next;
+			continue;
+		}
+		next = c->next;					 // 暂存下一个节点指针。
+		a = (cJSON_CONTAINER(c) && !(c->type & cJSON_IsReference)) ? cJSON_ALLOC(c) : up ? cJSON_ALLOC(up) : alloc;
+		cJSON_FreeIndex(c->internal); // 记录总在堆上，arena中的节点也要释放
+		// 如果当前节点不是引用类型、值字符串不在arena或输入缓冲区中并且不为空，则释放值字符串占用的内存
+		if (!(c->type & (cJSON_IsReference | cJSON_InArena | cJSON_InSitu)) && cJSON_VALUESTRING(c))
+			mem_free(a, c->valuestring);
 		// 如果当前节点的字符串不是常量并且字符串不为空，则释放字符串占用的内存
 		if (!(c->type & cJSON_StringIsConst) && c->string)
-			cJSON_free(c->string);
-		cJSON_free(c); // 释放当前节点。
-		c = next;	   // 更新循环判断条件，指向下一节点
+			mem_free(a, c->string);
+		if (c->type & cJSON_ArenaOwner) // 独占arena的根节点，整块释放arena
+			cJSON_DeleteArena(cJSON_ArenaOf(c));
+		else if (!(c->type & cJSON_InArena)) // arena中的节点随arena释放
+			mem_free(a, c);				 // 释放当前节点。
+		c = next;							 // 更新循环判断条件，指向下一节点
+	}
+}
+
+void cJSON_Delete(cJSON *c) { cJSON_DeleteWithAllocator(c, 0); }
+
+/*
+	显式栈：解析、渲染和复制嵌套的数组和对象时，记录还没有走完的容器，代替递归，
+	所以调用栈的用量与嵌套深度无关。前cJSON_STACK_LOCAL层放在调用者的栈上，更深时在堆上按2倍扩大。
+*/
+#define cJSON_STACK_LOCAL 32
+typedef struct
+{
+	cJSON **items;					 // 栈底是items[0]
+	int depth, size;				 // 栈深度和容量
+	const cJSON_Allocator *alloc;	 // 深层的栈从这个分配器分配
+	cJSON *local[cJSON_STACK_LOCAL]; // 嵌套不深的文档不分配内存
+} walk_stack;
+
+static void stack_init(walk_stack *s, const cJSON_Allocator *alloc)
+{
+	s->items = s->local, s->alloc = alloc;
+	s->depth = 0, s->size = cJSON_STACK_LOCAL;
+}
+
+/* 入栈，内存不足时返回0 */
+static int stack_push(walk_stack *s, cJSON *item)
+{
+	cJSON **items;
+	if (s->depth == s->size)
+	{
+		if (s->items != s->local)
+			items = (cJSON **)cJSON_grow(s->alloc, s->items, s->depth * sizeof(cJSON *), s->size * 2 * sizeof(cJSON *));
+		else if ((items = (cJSON **)mem_malloc(s->alloc, s->size * 2 * sizeof(cJSON *))))
+			memcpy(items, s->items, s->depth * sizeof(cJSON *));
+		if (!items)
+			return 0;
+		s->items = items, s->size *= 2;
+	}
+	s->items[s->depth++] = item;
+	return 1;
+}
+
+static void stack_free(walk_stack *s)
+{
+	if (s->items != s->local)
+		mem_free(s->alloc, s->items);
+}
+
+/* 遍历结束时释放栈，返回ret方便调用处直接return */
+static const char *stack_done(walk_stack *s, const char *ret)
+{
+	stack_free(s);
+	return ret;
+}
+
+/* 容器的右括号 */
+static char close_of(const cJSON *item) { return ((item->type & 255) == cJSON_Array) ? ']' : '}'; }
+
+/* 一次解析调用的全部状态，由入口函数放在栈上，沿解析函数逐层传递，不同线程的解析互不共享 */
+typedef struct
+{
+	const char *start;	// 输入的起点，用来换算出错位置的偏移和行列
+	const char *end;	// 输入的结尾，解析时不读取end及之后的字节
+	const char *ep;		// 出错位置
+	int error;			// 错误类型，cJSON_ErrorNone表示没有出错
+	cJSON_Arena *arena; // 本次解析使用的arena，为空时节点和字符串都从alloc分配
+	const cJSON_Allocator *alloc; // 为空时用cJSON_InitHooks设置的全局分配器
+	int insitu;			// 字符串在输入缓冲区中就地反转义，不另外分配
+	int sax;			// SAX解析，字符串反转义到scratch里，回调返回后即被覆盖
+	int lazy;			// 懒解析，容器只记下在输入中的范围，访问时再展开
+	unsigned *tape;		// 双阶段解析的结构索引（当前一段）：结构字符和引号在输入中的偏移
+	int tapecount;		// 这一段的条目数
+	int tapenext;		// 下一个要核对的条目
+	size_t tapepos;		// 第一阶段下次从这个偏移继续扫描
+	unsigned long long tapestring; // 扫描到的位置在字符串里时为全1
+	int tapecarry;		// 下一块的第一个字节被转义
+	int tapeescaped;	// 当前字符串在之前的块里出现过反斜杠
+	char *scratch;		// SAX解析复用的字符串缓冲区
+	size_t scratchsize; // scratch的大小
+} parse_state;
+
+/* 记录第一个错误，返回0方便调用处直接return */
+static const char *parse_fail(parse_state *ps, const char *at, int error)
+{
+	if (!ps->error)
+		ps->ep = at, ps->error = error;
+	return 0;
+}
+
+/* p处还有输入并且正好是字符c */
+static int parse_at(const parse_state *ps, const char *p, char c) { return p < ps->end && *p == c; }
+
+/* 解析过程中创建节点 */
+static cJSON *parse_new_item(parse_state *ps)
+{
+	cJSON *node;
+	if (!ps->arena)
+		node = cJSON_New_Item(ps->alloc);
+	else if ((node = (cJSON *)cJSON_ArenaAlloc(ps->arena, sizeof(cJSON))))
+		memset(node, 0, sizeof(cJSON));
+	if (!node)
+		parse_fail(ps, 0, cJSON_ErrorMemory);
+	return node;
+}
+
+/* 解析过程中为字符串分配内存 */
+static void *parse_malloc(parse_state *ps, size_t sz)
+{
+	void *mem = ps->arena ? cJSON_ArenaAlloc(ps->arena, sz) : mem_malloc(ps->alloc, sz);
+	if (!mem)
+		parse_fail(ps, 0, cJSON_ErrorMemory);
+	return mem;
+}
+
+/* 取SAX解析的字符串缓冲区，不够大时按2倍扩大，整次解析只分配几次 */
+static char *parse_scratch(parse_state *ps, size_t sz)
+{
+	size_t size = ps->scratchsize ? ps->scratchsize : 256;
+	if (sz <= ps->scratchsize)
+		return ps->scratch;
+	while (size < sz)
+		size *= 2;
+	mem_free(ps->alloc, ps->scratch); // 旧内容已经交给过回调，不需要保留
+	ps->scratchsize = 0;
+	if (!(ps->scratch = (char *)mem_malloc(ps->alloc, size)))
+		return (char *)parse_fail(ps, 0, cJSON_ErrorMemory);
+	ps->scratchsize = size;
+	return ps->scratch;
+}
+
+/* 给arena中的节点和指向输入缓冲区的键名打上标记，cJSON_Delete据此跳过逐个释放 */
+static void parse_mark(parse_state *ps, cJSON *item)
+{
+	if (ps->arena)
+		item->type |= cJSON_InArena;
+	if ((ps->arena || ps->insitu) && item->string)
+		item->type |= cJSON_StringIsConst;
+}
+
+/* 解析失败时释放已构建的部分，arena中的部分随arena一起回收 */
+static void parse_release(parse_state *ps, cJSON *item)
+{
+	if (!ps->arena)
+		cJSON_DeleteWithAllocator(item, ps->alloc);
+}
+
+/* 10的0到22次幂都能用double精确表示，快速路径中一次乘除只舍入一次，结果是正确舍入的 */
+static const double cJSON_pow10[23] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+									   1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+/* Eisel-Lemire算法用的5^q，规格化为最高位是1的128位值（高64位在前，负幂向上取整）。
+   只收录-64到64，覆盖常见的数值范围，更大更小的指数交给慢速路径 */
+#define cJSON_POW5_MIN (-64)
+#define cJSON_POW5_MAX 64
+static const unsigned long long cJSON_pow5[][2] = {
+	{0xa87fea27a539e9a5ull, 0x3f2398d747b36224ull}, {0xd29fe4b18e88640eull, 0x8eec7f0d19a03aadull},
+	{0x83a3eeeef9153e89ull, 0x1953cf68300424acull}, {0xa48ceaaab75a8e2bull, 0x5fa8c3423c052dd7ull},
+	{0xcdb02555653131b6ull, 0x3792f412cb06794dull}, {0x808e17555f3ebf11ull, 0xe2bbd88bbee40bd0ull},
+	{0xa0b19d2ab70e6ed6ull, 0x5b6aceaeae9d0ec4ull}, {0xc8de047564d20a8bull, 0xf245825a5a445275ull},
+	{0xfb158592be068d2eull, 0xeed6e2f0f0d56712ull}, {0x9ced737bb6c4183dull, 0x55464dd69685606bull},
+	{0xc428d05aa4751e4cull, 0xaa97e14c3c26b886ull}, {0xf53304714d9265dfull, 0xd53dd99f4b3066a8ull},
+	{0x993fe2c6d07b7fabull, 0xe546a8038efe4029ull}, {0xbf8fdb78849a5f96ull, 0xde98520472bdd033ull},
+	{0xef73d256a5c0f77cull, 0x963e66858f6d4440ull}, {0x95a8637627989aadull, 0xdde7001379a44aa8ull},
+	{0xbb127c53b17ec159ull, 0x5560c018580d5d52ull}, {0xe9d71b689dde71afull, 0xaab8f01e6e10b4a6ull},
+	{0x9226712162ab070dull, 0xcab3961304ca70e8ull}, {0xb6b00d69bb55c8d1ull, 0x3d607b97c5fd0d22ull},
+	{0xe45c10c42a2b3b05ull, 0x8cb89a7db77c506aull}, {0x8eb98a7a9a5b04e3ull, 0x77f3608e92adb242ull},
+	{0xb267ed1940f1c61cull, 0x55f038b237591ed3ull}, {0xdf01e85f912e37a3ull, 0x6b6c46dec52f6688ull},
+	{0x8b61313bbabce2c6ull, 0x2323ac4b3b3da015ull}, {0xae397d8aa96c1b77ull, 0xabec975e0a0d081aull},
+	{0xd9c7dced53c72255ull, 0x96e7bd358c904a21ull}, {0x881cea14545c7575ull, 0x7e50d64177da2e54ull},
+	{0xaa242499697392d2ull, 0xdde50bd1d5d0b9e9ull}, {0xd4ad2dbfc3d07787ull, 0x955e4ec64b44e864ull},
+	{0x84ec3c97da624ab4ull, 0xbd5af13bef0b113eull}, {0xa6274bbdd0fadd61ull, 0xecb1ad8aeacdd58eull},
+	{0xcfb11ead453994baull, 0x67de18eda5814af2ull}, {0x81ceb32c4b43fcf4ull, 0x80eacf948770ced7ull},
+	{0xa2425ff75e14fc31ull, 0xa1258379a94d028dull}, {0xcad2f7f5359a3b3eull, 0x096ee45813a04330ull},
+	{0xfd87b5f28300ca0dull, 0x8bca9d6e188853fcull}, {0x9e74d1b791e07e48ull, 0x775ea264cf55347eull},
+	{0xc612062576589ddaull, 0x95364afe032a819eull}, {0xf79687aed3eec551ull, 0x3a83ddbd83f52205ull},
+	{0x9abe14cd44753b52ull, 0xc4926a9672793543ull}, {0xc16d9a0095928a27ull, 0x75b7053c0f178294ull},
+	{0xf1c90080baf72cb1ull, 0x5324c68b12dd6339ull}, {0x971da05074da7beeull, 0xd3f6fc16ebca5e04ull},
+	{0xbce5086492111aeaull, 0x88f4bb1ca6bcf585ull}, {0xec1e4a7db69561a5ull, 0x2b31e9e3d06c32e6ull},
+	{0x9392ee8e921d5d07ull, 0x3aff322e62439fd0ull}, {0xb877aa3236a4b449ull, 0x09befeb9fad487c3ull},
+	{0xe69594bec44de15bull, 0x4c2ebe687989a9b4ull}, {0x901d7cf73ab0acd9ull, 0x0f9d37014bf60a11ull},
+	{0xb424dc35095cd80full, 0x538484c19ef38c95ull}, {0xe12e13424bb40e13ull, 0x2865a5f206b06fbaull},
+	{0x8cbccc096f5088cbull, 0xf93f87b7442e45d4ull}, {0xafebff0bcb24aafeull, 0xf78f69a51539d749ull},
+	{0xdbe6fecebdedd5beull, 0xb573440e5a884d1cull}, {0x89705f4136b4a597ull, 0x31680a88f8953031ull},
+	{0xabcc77118461cefcull, 0xfdc20d2b36ba7c3eull}, {0xd6bf94d5e57a42bcull, 0x3d32907604691b4dull},
+	{0x8637bd05af6c69b5ull, 0xa63f9a49c2c1b110ull}, {0xa7c5ac471b478423ull, 0x0fcf80dc33721d54ull},
+	{0xd1b71758e219652bull, 0xd3c36113404ea4a9ull}, {0x83126e978d4fdf3bull, 0x645a1cac083126eaull},
+	{0xa3d70a3d70a3d70aull, 0x3d70a3d70a3d70a4ull}, {0xccccccccccccccccull, 0xcccccccccccccccdull},
+	{0x8000000000000000ull, 0x0000000000000000ull}, {0xa000000000000000ull, 0x0000000000000000ull},
+	{0xc800000000000000ull, 0x0000000000000000ull}, {0xfa00000000000000ull, 0x0000000000000000ull},
+	{0x9c40000000000000ull, 0x0000000000000000ull}, {0xc350000000000000ull, 0x0000000000000000ull},
+	{0xf424000000000000ull, 0x0000000000000000ull}, {0x9896800000000000ull, 0x0000000000000000ull},
+	{0xbebc200000000000ull, 0x0000000000000000ull}, {0xee6b280000000000ull, 0x0000000000000000ull},
+	{0x9502f90000000000ull, 0x0000000000000000ull}, {0xba43b74000000000ull, 0x0000000000000000ull},
+	{0xe8d4a51000000000ull, 0x0000000000000000ull}, {0x9184e72a00000000ull, 0x0000000000000000ull},
+	{0xb5e620f480000000ull, 0x0000000000000000ull}, {0xe35fa931a0000000ull, 0x0000000000000000ull},
+	{0x8e1bc9bf04000000ull, 0x0000000000000000ull}, {0xb1a2bc2ec5000000ull, 0x0000000000000000ull},
+	{0xde0b6b3a76400000ull, 0x0000000000000000ull}, {0x8ac7230489e80000ull, 0x0000000000000000ull},
+	{0xad78ebc5ac620000ull, 0x0000000000000000ull}, {0xd8d726b7177a8000ull, 0x0000000000000000ull},
+	{0x878678326eac9000ull, 0x0000000000000000ull}, {0xa968163f0a57b400ull, 0x0000000000000000ull},
+	{0xd3c21bcecceda100ull, 0x0000000000000000ull}, {0x84595161401484a0ull, 0x0000000000000000ull},
+	{0xa56fa5b99019a5c8ull, 0x0000000000000000ull}, {0xcecb8f27f4200f3aull, 0x0000000000000000ull},
+	{0x813f3978f8940984ull, 0x4000000000000000ull}, {0xa18f07d736b90be5ull, 0x5000000000000000ull},
+	{0xc9f2c9cd04674edeull, 0xa400000000000000ull}, {0xfc6f7c4045812296ull, 0x4d00000000000000ull},
+	{0x9dc5ada82b70b59dull, 0xf020000000000000ull}, {0xc5371912364ce305ull, 0x6c28000000000000ull},
+	{0xf684df56c3e01bc6ull, 0xc732000000000000ull}, {0x9a130b963a6c115cull, 0x3c7f400000000000ull},
+	{0xc097ce7bc90715b3ull, 0x4b9f100000000000ull}, {0xf0bdc21abb48db20ull, 0x1e86d40000000000ull},
+	{0x96769950b50d88f4ull, 0x1314448000000000ull}, {0xbc143fa4e250eb31ull, 0x17d955a000000000ull},
+	{0xeb194f8e1ae525fdull, 0x5dcfab0800000000ull}, {0x92efd1b8d0cf37beull, 0x5aa1cae500000000ull},
+	{0xb7abc627050305adull, 0xf14a3d9e40000000ull}, {0xe596b7b0c643c719ull, 0x6d9ccd05d0000000ull},
+	{0x8f7e32ce7bea5c6full, 0xe4820023a2000000ull}, {0xb35dbf821ae4f38bull, 0xdda2802c8a800000ull},
+	{0xe0352f62a19e306eull, 0xd50b2037ad200000ull}, {0x8c213d9da502de45ull, 0x4526f422cc340000ull},
+	{0xaf298d050e4395d6ull, 0x9670b12b7f410000ull}, {0xdaf3f04651d47b4cull, 0x3c0cdd765f114000ull},
+	{0x88d8762bf324cd0full, 0xa5880a69fb6ac800ull}, {0xab0e93b6efee0053ull, 0x8eea0d047a457a00ull},
+	{0xd5d238a4abe98068ull, 0x72a4904598d6d880ull}, {0x85a36366eb71f041ull, 0x47a6da2b7f864750ull},
+	{0xa70c3c40a64e6c51ull, 0x999090b65f67d924ull}, {0xd0cf4b50cfe20765ull, 0xfff4b4e3f741cf6dull},
+	{0x82818f1281ed449full, 0xbff8f10e7a8921a4ull}, {0xa321f2d7226895c7ull, 0xaff72d52192b6a0dull},
+	{0xcbea6f8ceb02bb39ull, 0x9bf4f8a69f764490ull}, {0xfee50b7025c36a08ull, 0x02f236d04753d5b4ull},
+	{0x9f4f2726179a2245ull, 0x01d762422c946590ull}, {0xc722f0ef9d80aad6ull, 0x424d3ad2b7b97ef5ull},
+	{0xf8ebad2b84e0d58bull, 0xd2e0898765a7deb2ull}, {0x9b934c3b330c8577ull, 0x63cc55f49f88eb2full},
+	{0xc2781f49ffcfa6d5ull, 0x3cbf6b71c76b25fbull},
+};
+
+/* 64位乘64位，返回128位积的高64位，低64位写入lo */
+static unsigned long long mul_64(unsigned long long a, unsigned long long b, unsigned long long *lo)
+{
+#ifdef __SIZEOF_INT128__
+	__extension__ unsigned __int128 r = (unsigned __int128)a * b;
+	*lo = (unsigned long long)r;
+	return (unsigned long long)(r >> 64);
+#else
+	unsigned long long al = a & 0xffffffffull, ah = a >> 32, bl = b & 0xffffffffull, bh = b >> 32;
+	unsigned long long ll = al * bl, lh = al * bh, hl = ah * bl;
+	unsigned long long mid = (ll >> 32) + (lh & 0xffffffffull) + (hl & 0xffffffffull);
+	*lo = (mid << 32) | (ll & 0xffffffffull);
+	return ah * bh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+#endif
+}
+
+/* 前导零个数，x不为0 */
+static int clz_64(unsigned long long x)
+{
+#if defined(__GNUC__)
+	return __builtin_clzll(x);
+#else
+	int n = 0;
+	while (!(x >> 63))
+		x <<= 1, n++;
+	return n;
+#endif
+}
+
+/* 末尾零个数，即最低位1的位置，x不为0 */
+static int ctz_64(unsigned long long x)
+{
+#if defined(__GNUC__)
+	return __builtin_ctzll(x);
+#else
+	int n = 0;
+	while (!(x & 1))
+		x >>= 1, n++;
+	return n;
+#endif
+}
+
+/* Eisel-Lemire快速路径：m*10^q直接截取出正确舍入的double。精度不足以判定舍入方向时返回0，交给慢速路径 */
+static int parse_number_fast(unsigned long long m, int q, double *out)
+{
+	const unsigned long long *p;
+	unsigned long long hi, lo, hi2, lo2, mantissa, bits;
+	int lz, upperbit;
+	long e;
+
+	if (q < cJSON_POW5_MIN || q > cJSON_POW5_MAX)
+		return 0;
+	p = cJSON_pow5[q - cJSON_POW5_MIN];
+	lz = clz_64(m);
+	m <<= lz; // 规格化，最高位为1
+	hi = mul_64(m, p[0], &lo);
+	if ((hi & 0x1FF) == 0x1FF && lo + m < lo) // 截断的低位可能进位到结果里，补上5^q的低64位再看
+	{
+		hi2 = mul_64(m, p[1], &lo2);
+		lo += hi2;
+		if (lo < hi2)
+			hi++;
+		if (lo + 1 == 0 && (hi & 0x1FF) == 0x1FF && lo2 + m < lo2)
+			return 0;
 	}
+	upperbit = (int)(hi >> 63);
+	mantissa = hi >> (upperbit + 9); // 取54位，多出的一位用于舍入
+	lz += 1 ^ upperbit;
+	if (lo == 0 && (hi & 0x1FF) == 0 && (mantissa & 3) == 1)
+		return 0; // 恰好落在两个double正中间，无法判定
+	mantissa += mantissa & 1;
+	mantissa >>= 1;
+	if (mantissa >= (1ull << 53)) // 舍入进位溢出到下一个二进制数量级
+	{
+		mantissa = 1ull << 52;
+		lz--;
+	}
+	mantissa &= ~(1ull << 52);
+	e = (((152170 + 65536) * q) >> 16) + 1024 + 63 - lz; // (217706*q)>>16 即 floor(q*log2(10))
+	if (e < 1 || e > 2046)
+		return 0; // 次正规数或溢出，交给慢速路径
+	bits = mantissa | ((unsigned long long)e << 52);
+	memcpy(out, &bits, sizeof(bits));
+	return 1;
+}
+
+/* 慢速路径：交给strtod正确舍入。strtod要求'\0'结尾，所以先复制一份；它按当前locale识别小数点，停在'.'上说明locale的小数点不是'.'，
+   这时再用snprintf格式化0.5取出locale的小数点替换后重解析。不调用localeconv，它返回的静态缓冲区在多线程下不安全。分配失败返回0 */
+static int parse_number_slow(const char *start, const char *end, double *d, const cJSON_Allocator *a)
+{
+	char buf[64], *tmp = buf, *stop, probe[8];
+	size_t len = end - start;
+
+	if (len >= sizeof(buf) && !(tmp = (char *)mem_malloc(a, len + 1)))
+		return 0;
+	memcpy(tmp, start, len);
+	tmp[len] = 0;
+	*d = strtod(tmp, &stop);
+	if (*stop == '.' && snprintf(probe, sizeof(probe), "%.1f", 0.5) == 3) // "0,5"之类，probe[1]即locale的小数点
+	{
+		*stop = probe[1];
+		*d = strtod(tmp, 0);
+	}
+	if (tmp != buf)
+		mem_free(a, tmp);
+	return 1;
+}
+
+/* double截断为int64，超出范围时取边界值，NaN取0 */
+static long long double_to_int64(double d)
+{
+	if (d != d)
+		return 0;
+	return (d >= 9223372036854775807.0) ? LLONG_MAX : (d <= -9223372036854775808.0) ? LLONG_MIN : (long long)d;
 }
 
+/* int64转int，超出范围时取边界值 */
+static int int64_to_int(long long v) { return (v >= INT_MAX) ? INT_MAX : (v <= INT_MIN) ? INT_MIN : (int)v; }
+
 /* 解析输入的文本来生成一个数字，并将结果填充到item里。 */
-static const char *parse_number(cJSON *item, const char *num)
+static const char *parse_number(cJSON *item, const char *num, parse_state *ps)
 {
 	/*
-		n用于累加解析出的数字值，sign用来存储数字的符号，scale用于记录小数点后的数字位数，
-		subscale用于存储指数部分的数值，signsubscale用于存储指数部分的符号。
+		m累加最多19位有效数字（不会溢出64位无符号整数），digits记录已累加的有效位数，
+		exp10是小数点位置和被舍去的整数位带来的十进制指数，exponent是指数部分，
+		truncated表示舍去的数字里有非零位，integral表示既没有小数部分也没有指数部分。
 	*/
-	double n = 0, sign = 1, scale = 0;
-	int subscale = 0, signsubscale = 1;
-
-	if (*num == '-')
-		sign = -1, num++; /* 处理负号 */
-	if (*num == '0')
+	const char *start, *end = ps->end;
+	unsigned long long m = 0;
+	int digits = 0, exp10 = 0, exponent = 0, signexponent = 1, neg = 0, truncated = 0, integral = 1, fraction, exact = 0;
+	long long i = 0;
+	double n;
+
+	if (parse_at(ps, num, '-'))
+		neg = 1, num++; /* 处理负号 */
+	start = num;	   // 慢速路径从符号之后开始解析
+	if (parse_at(ps, num, '0'))
 		num++; /* 跳过首位零 */
-	if (*num >= '1' && *num <= '9')
-		do
-			n = (n * 10.0) + (*num++ - '0');
-		while (*num >= '0' && *num <= '9'); /* 获取整数部分 */
-	if (*num == '.' && num[1] >= '0' && num[1] <= '9') // 小数点后有效
+	for (fraction = 0; fraction < 2; fraction++) /* 先整数部分，再小数部分 */
 	{
-		num++;
-		do
-			n = (n * 10.0) + (*num++ - '0'), scale--;
-		while (*num >= '0' && *num <= '9');
-	} /* 获取小数部分 */
-	if (*num == 'e' || *num == 'E') /* 指数部分 */
+		if (fraction)
+		{
+			if (!parse_at(ps, num, '.') || end - num < 2 || num[1] < '0' || num[1] > '9')
+				break;
+			integral = 0, num++; /* 小数点后有效 */
+		}
+		else if (num == end || *num < '1' || *num > '9')
+			continue; /* 没有整数部分 */
+		while (num < end && *num >= '0' && *num <= '9')
+		{
+			if (digits < 19) // 有效数字累加到整数里
+			{
+				m = m * 10 + (*num - '0');
+				if (m)
+					digits++; // 小数部分开头的0不算有效位
+				exp10 -= fraction;
+			}
+			else // 超出的数字只影响指数
+			{
+				exp10 += !fraction;
+				truncated |= (*num != '0');
+			}
+			num++;
+		}
+	}
+	if (parse_at(ps, num, 'e') || parse_at(ps, num, 'E')) /* 指数部分 */
 	{
+		integral = 0;
 		num++;
-		if (*num == '+')
+		if (parse_at(ps, num, '+'))
+			num++;
+		else if (parse_at(ps, num, '-'))
+			signexponent = -1, num++; /* 有负号 */
+		while (num < end && *num >= '0' && *num <= '9')
+		{
+			if (exponent < 100000) // 更大的指数结果也只是0或无穷，防止int溢出
+				exponent = (exponent * 10) + (*num - '0');
 			num++;
-		else if (*num == '-')
-			signsubscale = -1, num++; /* 有负号 */
-		while (*num >= '0' && *num <= '9')
-			subscale = (subscale * 10) + (*num++ - '0'); /* 获取指数部分 */
+		}
 	} // bug：这样的数没有错误校验（2.3.3）
+	exp10 += signexponent * exponent;
 
-	n = sign * n * pow(10.0, (scale + subscale * signsubscale)); /* 计算最终结果 */
-
-	item->valuedouble = n;	 // valuedouble存精确值
-	item->valueint = (int)n; // valueint存整数值
+	if (integral && !exp10 && !truncated) /* 整数直接由64位整数转换，不经过浮点运算 */
+	{
+		n = (double)m;
+		if (m <= 9223372036854775807ull + neg) // 在int64范围内，valueint64保存精确值
+			exact = 1, i = (neg && m) ? -(long long)(m - 1) - 1 : (long long)m;
+	}
+	else if (!m && !truncated)
+		n = 0;
+#if !defined(FLT_EVAL_METHOD) || FLT_EVAL_METHOD == 0 // x87那样的扩展精度会二次舍入，只能走慢速路径
+	else if (!truncated && m <= (1ull << 53) && exp10 >= -22 && exp10 <= 22)
+		n = (exp10 < 0) ? (double)m / cJSON_pow10[-exp10] : (double)m * cJSON_pow10[exp10]; /* Clinger快速路径 */
+#endif
+	else if ((truncated || !parse_number_fast(m, exp10, &n)) && !parse_number_slow(start, num, &n, ps->alloc))
+		return parse_fail(ps, 0, cJSON_ErrorMemory);
+	if (neg)
+		n = -n;
+
+	item->valuedouble = n;								 // valuedouble存最接近的double
+	item->valueint64 = exact ? i : double_to_int64(n); // valueint64存精确整数，小数和超出范围的数由double截断
+	item->valueint = int64_to_int(item->valueint64);	 // valueint存整数值，超出范围时取边界值
 	item->type = cJSON_Number;
 	return num;
 }
 
-/* 计算大于或等于x的最小的2的幂次方 */
-static int pow2gt(int x) // 本质是将二进制数的最高位1赋给所有位后再加1
+/* 流式输出默认的缓冲区大小 */
+#define cJSON_STREAM_CHUNK 65536
+
+/* 计算大于或等于x的最小的2的幂次方，超出size_t的范围时返回0 */
+static size_t pow2gt(size_t x) // 本质是将二进制数的最高位1赋给所有位后再加1
 {
 	--x;		  // 处理已经是2的幂次方的边界情况
 	x |= x >> 1;  // 最高位1赋给次高位
 	x |= x >> 2;  // 最高两位1赋给次高两位
 	x |= x >> 4;  // 最高四位1赋给次高四位
 	x |= x >> 8;  // 最高八位1赋给次高八位
-	x |= x >> 16; // 最高十六位1赋给次高十六位，至此，最高位下所有位都为1
+	x |= x >> 16; // 最高十六位1赋给次高十六位
+	if (sizeof(size_t) > 4)
+		x |= x >> 16 >> 16; // 64位时再处理高32位，至此，最高位下所有位都为1（分两次移位，32位平台上不会移出位宽）
 	return x + 1; // 加1得到最小大于等于x的2的幂次方
 }
 
 typedef struct // 打印缓冲区结构体
 {
-	char *buffer; // 缓冲区字符串
-	int length;	  // 缓冲区最大长度
-	int offset;	  // 缓冲区字符串偏移量（已用长度）
+	char *buffer;		 // 缓冲区字符串
+	size_t length;		 // 缓冲区最大长度
+	size_t offset;		 // 缓冲区字符串偏移量（已用长度）
+	cJSON_WriteFn write; // 不为空时是流式输出：缓冲区满了先把已有内容交给write，而不是扩容
+	void *ctx;			 // 传给write的参数
+	int fixed;			 // 调用者提供的缓冲区：放不下时失败，既不扩容也不释放
+	const cJSON_Allocator *alloc; // 缓冲区和深层的遍历栈都从这个分配器分配，为空时用全局分配器
 } printbuffer;
 
 /* 确保printbuffer结构体中的缓冲区足够大以容纳needed字节 */
-static char *ensure(printbuffer *p, int needed)
+static char *ensure(printbuffer *p, size_t needed)
 {
 	// 分配新的缓冲区
-	char *newbuffer;
+	char *newbuffer = 0;
 	// 新的缓冲区大小
-	int newsize;
+	size_t newsize;
 
 	// 检查缓冲区是否有效
 	if (!p || !p->buffer)
 		return 0;
 
-	needed += p->offset; // 加上偏移量后的长度
+	needed = (needed > (size_t)-1 - p->offset) ? (size_t)-1 : needed + p->offset; // 加上偏移量后的长度，超出size_t的范围时取最大值，下面扩容必然失败
 
 	if (needed <= p->length)		  // 缓冲区大小足够
 		return p->buffer + p->offset; // 返回偏移量后的缓冲区字符指针
 
-	newsize = pow2gt(needed);				   // 内存对齐
-	newbuffer = (char *)cJSON_malloc(newsize); // 分配新的缓冲区内存
-	if (!newbuffer)							   // 分配失败
+	if (p->write && p->offset) // 流式输出，[0, offset)都已写完，交出去后从头复用缓冲区
+	{
+		if (!p->write(p->ctx, p->buffer, p->offset))
+		{
+			mem_free(p->alloc, p->buffer); // 写出失败和内存不足一样处理，之后的ensure都返回0
+			p->length = 0, p->buffer = 0;
+			return 0;
+		}
+		needed -= p->offset;
+		p->offset = 0;
+		if (needed <= p->length)
+			return p->buffer;
+	}
+	if (p->fixed)
+		return 0;
+
+	newsize = pow2gt(needed); // 内存对齐
+	if (newsize)			  // 扩大缓冲区，有realloc时尽量原地扩大，只需保留已写的offset字节
+		newbuffer = (char *)cJSON_grow(p->alloc, p->buffer, p->offset, newsize);
+	if (!newbuffer) // 分配失败，或者长度超出size_t的范围
 	{
-		cJSON_free(p->buffer);		  // 释放旧的缓冲区内存
+		mem_free(p->alloc, p->buffer); // 释放旧的缓冲区内存
 		p->length = 0, p->buffer = 0; // 重置缓冲区信息
 		return 0;
 	}
-	if (newbuffer)								 // 分配成功
-		memcpy(newbuffer, p->buffer, p->length); // 将旧的缓冲区内容复制到新的缓冲区
-	cJSON_free(p->buffer);						 // 释放旧的缓冲区内存
-	p->length = newsize;						 // 更新缓冲区大小
-	p->buffer = newbuffer;						 // 更新缓冲区字符指针
-	return newbuffer + p->offset;				 // 返回偏移量后的缓冲区字符指针
+	p->length = newsize;		  // 更新缓冲区大小
+	p->buffer = newbuffer;		  // 更新缓冲区字符指针
+	return newbuffer + p->offset; // 返回偏移量后的缓冲区字符指针
 }
 
-/* 更新打印缓冲区的偏移量 */
-static int update(printbuffer *p)
+/* 00到99的两位数字表，整数转字符串时一次写两位 */
+static const char cJSON_digits2[201] = "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+									   "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+									   "8081828384858687888990919293949596979899";
+
+/* 把无符号整数写成十进制，不写结尾的'\0'，返回写入的字符数 */
+static int print_uint64(char *out, unsigned long long v)
 {
-	char *str;
-	if (!p || !p->buffer)
-		return 0;					// 缓冲区无效
-	str = p->buffer + p->offset;	// 获取新增字符指针
-	return p->offset + strlen(str); // 在原有偏移量上加上新增字符的长度
+	char tmp[20], *t = tmp + sizeof(tmp);
+	int len;
+	while (v >= 100)
+	{
+		t -= 2;
+		memcpy(t, cJSON_digits2 + (v % 100) * 2, 2);
+		v /= 100;
+	}
+	if (v >= 10)
+		t -= 2, memcpy(t, cJSON_digits2 + v * 2, 2);
+	else
+		*--t = (char)('0' + v);
+	len = (int)(tmp + sizeof(tmp) - t);
+	memcpy(out, t, len);
+	return len;
+}
+
+/*
+	Grisu2最短往返输出：用64位整数模拟的浮点数(f*2^e)和预先算好的10的幂，
+	在double的舍入区间内生成尽量少的十进制位，重新解析时一定得到同一个double。
+*/
+typedef struct
+{
+	unsigned long long f;
+	int e;
+} cJSON_diyfp;
+
+/* 10^(8i-348)规格化后的有效位和二进制指数，i取0到86 */
+static const unsigned long long cJSON_cached_f[87] = {
+	0xfa8fd5a0081c0288ull, 0xbaaee17fa23ebf76ull, 0x8b16fb203055ac76ull, 0xcf42894a5dce35eaull,
+	0x9a6bb0aa55653b2dull, 0xe61acf033d1a45dfull, 0xab70fe17c79ac6caull, 0xff77b1fcbebcdc4full,
+	0xbe5691ef416bd60cull, 0x8dd01fad907ffc3cull, 0xd3515c2831559a83ull, 0x9d71ac8fada6c9b5ull,
+	0xea9c227723ee8bcbull, 0xaecc49914078536dull, 0x823c12795db6ce57ull, 0xc21094364dfb5637ull,
+	0x9096ea6f3848984full, 0xd77485cb25823ac7ull, 0xa086cfcd97bf97f4ull, 0xef340a98172aace5ull,
+	0xb23867fb2a35b28eull, 0x84c8d4dfd2c63f3bull, 0xc5dd44271ad3cdbaull, 0x936b9fcebb25c996ull,
+	0xdbac6c247d62a584ull, 0xa3ab66580d5fdaf6ull, 0xf3e2f893dec3f126ull, 0xb5b5ada8aaff80b8ull,
+	0x87625f056c7c4a8bull, 0xc9bcff6034c13053ull, 0x964e858c91ba2655ull, 0xdff9772470297ebdull,
+	0xa6dfbd9fb8e5b88full, 0xf8a95fcf88747d94ull, 0xb94470938fa89bcfull, 0x8a08f0f8bf0f156bull,
+	0xcdb02555653131b6ull, 0x993fe2c6d07b7facull, 0xe45c10c42a2b3b06ull, 0xaa242499697392d3ull,
+	0xfd87b5f28300ca0eull, 0xbce5086492111aebull, 0x8cbccc096f5088ccull, 0xd1b71758e219652cull,
+	0x9c40000000000000ull, 0xe8d4a51000000000ull, 0xad78ebc5ac620000ull, 0x813f3978f8940984ull,
+	0xc097ce7bc90715b3ull, 0x8f7e32ce7bea5c70ull, 0xd5d238a4abe98068ull, 0x9f4f2726179a2245ull,
+	0xed63a231d4c4fb27ull, 0xb0de65388cc8ada8ull, 0x83c7088e1aab65dbull, 0xc45d1df942711d9aull,
+	0x924d692ca61be758ull, 0xda01ee641a708deaull, 0xa26da3999aef774aull, 0xf209787bb47d6b85ull,
+	0xb454e4a179dd1877ull, 0x865b86925b9bc5c2ull, 0xc83553c5c8965d3dull, 0x952ab45cfa97a0b3ull,
+	0xde469fbd99a05fe3ull, 0xa59bc234db398c25ull, 0xf6c69a72a3989f5cull, 0xb7dcbf5354e9beceull,
+	0x88fcf317f22241e2ull, 0xcc20ce9bd35c78a5ull, 0x98165af37b2153dfull, 0xe2a0b5dc971f303aull,
+	0xa8d9d1535ce3b396ull, 0xfb9b7cd9a4a7443cull, 0xbb764c4ca7a44410ull, 0x8bab8eefb6409c1aull,
+	0xd01fef10a657842cull, 0x9b10a4e5e9913129ull, 0xe7109bfba19c0c9dull, 0xac2820d9623bf429ull,
+	0x80444b5e7aa7cf85ull, 0xbf21e44003acdd2dull, 0x8e679c2f5e44ff8full, 0xd433179d9c8cb841ull,
+	0x9e19db92b4e31ba9ull, 0xeb96bf6ebadf77d9ull, 0xaf87023b9bf0ee6bull,
+};
+static const short cJSON_cached_e[87] = {
+	-1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980, -954, -927, -901, -874, -847, -821,
+	-794, -768, -741, -715, -688, -661, -635, -608, -582, -555, -529, -502, -475, -449, -422, -396,
+	-369, -343, -316, -289, -263, -236, -210, -183, -157, -130, -103, -77, -50, -24, 3, 30,
+	56, 83, 109, 136, 162, 189, 216, 242, 269, 295, 322, 348, 375, 402, 428, 455,
+	481, 508, 534, 561, 588, 614, 641, 667, 694, 720, 747, 774, 800, 827, 853, 880,
+	907, 933, 960, 986, 1013, 1039, 1066,
+};
+
+/* 10的0到19次幂 */
+static const unsigned long long cJSON_pow10_u64[20] = {1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull,
+														100000000ull, 1000000000ull, 10000000000ull, 100000000000ull, 1000000000000ull,
+														10000000000000ull, 100000000000000ull, 1000000000000000ull, 10000000000000000ull,
+														100000000000000000ull, 1000000000000000000ull, 10000000000000000000ull};
+
+/* 两个diyfp相乘，积取高64位并四舍五入 */
+static cJSON_diyfp diyfp_mul(cJSON_diyfp a, cJSON_diyfp b)
+{
+	cJSON_diyfp r;
+	unsigned long long lo;
+	r.f = mul_64(a.f, b.f, &lo) + (lo >> 63);
+	r.e = a.e + b.e + 64;
+	return r;
+}
+
+/* 左移到最高位为1 */
+static cJSON_diyfp diyfp_normalize(cJSON_diyfp a)
+{
+	int s = clz_64(a.f);
+	a.f <<= s;
+	a.e -= s;
+	return a;
 }
 
-/* 把数字从所给的cJSON对象优雅地渲染成字符串。 */
-static char *print_number(cJSON *item, printbuffer *p)
+/* 微调最后一位，在保证往返的前提下让结果尽量接近真实值 */
+static void grisu_round(char *buf, int len, unsigned long long delta, unsigned long long rest, unsigned long long ten_kappa, unsigned long long wp_w)
 {
-	char *str = 0;				  // 用于接取数字字符串
-	double d = item->valuedouble; // 获取数字值
-	if (d == 0)					  // 如果双精度值为 0，进行特殊处理。
+	while (rest < wp_w && delta - rest >= ten_kappa && (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w))
 	{
-		if (p)					// 如果存在打印缓冲区
-			str = ensure(p, 2); // 确保缓冲区足够大,赋给str
-		else
-			str = (char *)cJSON_malloc(2); /* 特殊处理0的情况 */
-		if (str)
-			strcpy(str, "0"); // 将字符串"0"复制给str
-							  // bug:似乎缺少分配失败的处理
+		buf[len - 1]--;
+		rest += ten_kappa;
 	}
-	/*
-		如果双精度值与整数值相等，并且在 INT_MIN 和 INT_MAX 范围内，
-		则以整数形式输出。DBL_EPSILON是双精度浮点数的最小正误差值。
-		浮点数比较注意误差不要直接用 ==
-	*/
-	else if (fabs(((double)item->valueint) - d) <= DBL_EPSILON && d <= INT_MAX && d >= INT_MIN)
+}
+
+/* 把正的有限double转成十进制数字串，值为buf*10^k，返回位数（不超过17位） */
+static int grisu2(double d, char *buf, int *k)
+{
+	unsigned long long bits, delta, p2, rest, one_f, wp_w;
+	unsigned int p1;
+	cJSON_diyfp v, w, wp, wm, c;
+	int len = 0, kappa, one_e, idx;
+	double dk;
+
+	memcpy(&bits, &d, sizeof(bits));
+	v.f = bits & 0xFFFFFFFFFFFFFull;
+	v.e = (int)(bits >> 52);
+	if (v.e) /* 规格化数补上隐藏位 */
+		v.f += 1ull << 52, v.e -= 1075;
+	else
+		v.e = -1074;
+
+	/* 舍入区间的上下界，下界对齐到上界的指数 */
+	wp.f = (v.f << 1) + 1, wp.e = v.e - 1;
+	while (!(wp.f & (1ull << 53)))
+		wp.f <<= 1, wp.e--;
+	wp.f <<= 10, wp.e -= 10;
+	if (v.f == (1ull << 52)) /* 2的整数次幂下方的区间只有上方的一半 */
+		wm.f = (v.f << 2) - 1, wm.e = v.e - 2;
+	else
+		wm.f = (v.f << 1) - 1, wm.e = v.e - 1;
+	wm.f <<= wm.e - wp.e, wm.e = wp.e;
+
+	/* 选一个10的幂，把上界的二进制指数缩放到[-60, -32]之间 */
+	dk = (-61 - wp.e) * 0.30102999566398114 + 347;
+	idx = (int)dk;
+	if (dk - idx > 0.0)
+		idx++;
+	idx = (idx >> 3) + 1;
+	*k = -(-348 + idx * 8);
+	c.f = cJSON_cached_f[idx], c.e = cJSON_cached_e[idx];
+
+	w = diyfp_mul(diyfp_normalize(v), c);
+	wp = diyfp_mul(wp, c);
+	wm = diyfp_mul(wm, c);
+	wm.f++, wp.f--; /* 各收紧一个单位，抵消乘法的误差 */
+
+	/* 从上界开始逐位生成，直到剩余部分落入区间 */
+	delta = wp.f - wm.f;
+	wp_w = wp.f - w.f;
+	one_e = -wp.e;
+	one_f = 1ull << one_e;
+	p1 = (unsigned int)(wp.f >> one_e); // 整数部分
+	p2 = wp.f & (one_f - 1);			// 小数部分
+	for (kappa = 10; kappa > 0 && p1 < cJSON_pow10_u64[kappa - 1]; kappa--)
+		;
+	while (kappa > 0)
 	{
-		if (p)
-			str = ensure(p, 21);
-		else
-			str = (char *)cJSON_malloc(21); /* 一个64位无符号整数的最大值加1可以用21个字符来表示 */
-		if (str)
-			sprintf(str, "%d", item->valueint); // 将整数值转换为字符串，并复制给str
+		unsigned int div = (unsigned int)cJSON_pow10_u64[kappa - 1], digit = p1 / div;
+		p1 %= div;
+		if (digit || len)
+			buf[len++] = (char)('0' + digit);
+		kappa--;
+		rest = ((unsigned long long)p1 << one_e) + p2;
+		if (rest <= delta)
+		{
+			*k += kappa;
+			grisu_round(buf, len, delta, rest, cJSON_pow10_u64[kappa] << one_e, wp_w);
+			return len;
+		}
 	}
-	else // 以浮点形式输出
+	for (;;)
 	{
-		if (p)
-			str = ensure(p, 64);
-		else
-			str = (char *)cJSON_malloc(64); /* 这里选择了一个合适的内存分配大小作为权衡 */
-		if (str)
+		int digit;
+		p2 *= 10;
+		delta *= 10;
+		digit = (int)(p2 >> one_e);
+		if (digit || len)
+			buf[len++] = (char)('0' + digit);
+		p2 &= one_f - 1;
+		kappa--;
+		if (p2 < delta)
 		{
-			// 当d是非常接近整数的小数，或者d的绝对值小于1.0e60时，保留整数部分即可
-			if (fabs(floor(d) - d) <= DBL_EPSILON && fabs(d) < 1.0e60) // floor是向下取整，给了64个字符，不超过60位不用科学计数法
-				sprintf(str, "%.0f", d);							   // 小数点后保留零位
-			// 当d的绝对值非常小（小于1.0e-6）或非常大（大于1.0e9）时，使用科学计数法格式化
-			else if (fabs(d) < 1.0e-6 || fabs(d) > 1.0e9)
-				sprintf(str, "%e", d);
-			// 在其他情况下，使用标准的浮点数格式化
-			else
-				sprintf(str, "%f", d);
+			*k += kappa;
+			grisu_round(buf, len, delta, p2, one_f, (-kappa < 20) ? wp_w * cJSON_pow10_u64[-kappa] : 0);
+			return len;
+		}
+	}
+}
+
+/* 把double写成能精确往返的最短形式，返回长度（不含结尾的'\0'）。out至少要有32字节 */
+static int print_double(char *out, double d)
+{
+	char digits[20], *o = out;
+	int len, k, kk, e;
+
+	if (d != d || d - d != d - d) // NaN和无穷不是合法的JSON数字
+	{
+		memcpy(out, "null", 5);
+		return 4;
+	}
+	if (d < 0 || (d == 0 && 1 / d < 0)) // 负数和-0都输出负号
+		*o++ = '-', d = -d;
+	if (d < 9007199254740992.0 && d == (double)(unsigned long long)d) // 2^53以内的整数直接按整数输出
+	{
+		o += print_uint64(o, (unsigned long long)d);
+		*o = 0;
+		return (int)(o - out);
+	}
+
+	len = grisu2(d, digits, &k);
+	kk = len + k; /* 小数点位于第kk位数字之后 */
+	if (kk > 0 && kk <= 21)
+	{
+		if (k >= 0) /* 整数，末尾补零 */
+		{
+			memcpy(o, digits, len), o += len;
+			memset(o, '0', k), o += k;
 		}
+		else /* 小数点在数字中间 */
+		{
+			memcpy(o, digits, kk), o += kk;
+			*o++ = '.';
+			memcpy(o, digits + kk, len - kk), o += len - kk;
+		}
+	}
+	else if (kk <= 0 && kk > -6) /* 0.000ddd */
+	{
+		*o++ = '0', *o++ = '.';
+		memset(o, '0', -kk), o += -kk;
+		memcpy(o, digits, len), o += len;
+	}
+	else /* 科学计数法 d.ddde±x */
+	{
+		*o++ = digits[0];
+		if (len > 1)
+		{
+			*o++ = '.';
+			memcpy(o, digits + 1, len - 1), o += len - 1;
+		}
+		e = kk - 1;
+		*o++ = 'e';
+		*o++ = (e < 0) ? '-' : '+';
+		o += print_uint64(o, (unsigned long long)(e < 0 ? -e : e));
+	}
+	*o = 0;
+	return (int)(o - out);
+}
+
+/* valueint64与valuedouble是同一个数，可以按整数输出。valueint64在2^63以上饱和成LLONG_MAX，而(double)LLONG_MAX舍入成2^63，只比较两者不够，还要限定在int64范围内 */
+static int number_is_int64(const cJSON *item)
+{
+	double d = item->valuedouble;
+	return d == (double)item->valueint64 && d < 9223372036854775808.0 && d >= -9223372036854775808.0;
+}
+
+/* 把数字写成文本，返回长度（不含结尾的'\0'）。out至少要有32字节 */
+static int number_text(cJSON *item, char *out)
+{
+	char *str = out;
+	double d = item->valuedouble;
+
+	/* valueint64与valuedouble一致时按精确整数输出，不经过浮点运算；-0交给下面保留符号 */
+	if (number_is_int64(item) && (d != 0 || 1 / d > 0))
+	{
+		if (item->valueint64 < 0)
+			*str++ = '-';
+		str += print_uint64(str, (item->valueint64 < 0) ? 0ull - (unsigned long long)item->valueint64 : (unsigned long long)item->valueint64);
+		*str = 0;
+		return (int)(str - out);
+	}
+	return print_double(out, d); // 其余按最短往返形式输出，保证Parse(Print(x))得到同一个double
+}
+
+/*
+	把数字从所给的cJSON对象优雅地渲染进缓冲区，offset随之前进，返回写入的字节数，失败返回0。
+	缓冲区剩余32字节以上时直接写进去，否则先写到栈上，按实际长度ensure后再复制，调用者提供的缓冲区可以正好放下。
+*/
+static int print_number(cJSON *item, printbuffer *p)
+{
+	char tmp[32], *out = (p->offset + 32 <= p->length) ? p->buffer + p->offset : tmp;
+	int len = number_text(item, out);
+
+	if (out == tmp)
+	{
+		if (!(out = ensure(p, len + 1)))
+			return 0;
+		memcpy(out, tmp, len + 1);
 	}
-	return str;
+	p->offset += len;
+	return len;
 }
 
 /* 解析一个长度为4的十六进制字符串，并返回对应的无符号整数。*/
@@ -299,37 +1169,129 @@ static unsigned parse_hex4(const char *str)
 通过检查输入文本中每个字符的第一个字节与这些标志的匹配情况，
 可以确定字符的编码长度并进行相应的解析处理。 */
 static const unsigned char firstByteMark[7] = {0x00, 0x00, 0xC0, 0xE0, 0xF0, 0xF8, 0xFC};
-static const char *parse_string(cJSON *item, const char *str)
+
+/*
+	字符串扫描：返回从p开始第一个引号、反斜杠或控制字符的位置，没有则返回end，
+	中间都是可以原样复制的普通字符。向量版本一次比较16/32个字节，只在整块都位于end之前时读取，
+	不足一块的尾部逐个检查。
+*/
+static const char *scan_string_scalar(const char *p, const char *end)
+{
+	while (p < end && *p != '\"' && *p != '\\' && (unsigned char)*p >= 32)
+		p++;
+	return p;
+}
+
+#ifdef cJSON_USE_SSE2
+static const char *scan_string_sse2(const char *p, const char *end)
+{
+	const __m128i quote = _mm_set1_epi8('\"'), backslash = _mm_set1_epi8('\\'), ctrl = _mm_set1_epi8(31);
+	__m128i v;
+	int mask;
+	for (; end - p >= 16; p += 16)
+	{
+		v = _mm_loadu_si128((const __m128i *)p);
+		mask = _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)),
+											  _mm_cmpeq_epi8(_mm_min_epu8(v, ctrl), v))); // 无符号v<=31即控制字符
+		if (mask)
+			return p + __builtin_ctz(mask);
+	}
+	return scan_string_scalar(p, end);
+}
+
+#ifdef cJSON_USE_AVX2
+__attribute__((target("avx2"))) static const char *scan_string_avx2(const char *p, const char *end)
+{
+	const __m256i quote = _mm256_set1_epi8('\"'), backslash = _mm256_set1_epi8('\\'), ctrl = _mm256_set1_epi8(31);
+	__m256i v;
+	unsigned mask;
+	for (; end - p >= 32; p += 32)
+	{
+		v = _mm256_loadu_si256((const __m256i *)p);
+		mask = (unsigned)_mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, quote), _mm256_cmpeq_epi8(v, backslash)),
+															 _mm256_cmpeq_epi8(_mm256_min_epu8(v, ctrl), v)));
+		if (mask)
+			return p + __builtin_ctz(mask);
+	}
+	return scan_string_sse2(p, end);
+}
+#endif
+#endif
+
+/* 按CPU能力选择扫描实现：装载时检测一次，之后每段字符串都经函数指针直接调用。构造函数在main和用户线程之前运行，指针只在这里写一次 */
+#ifdef cJSON_USE_AVX2
+static const char *(*scan_string)(const char *p, const char *end) = scan_string_sse2;
+__attribute__((constructor)) static void scan_string_init(void)
+{
+	__builtin_cpu_init(); // 构造函数可能先于libgcc的CPU检测运行，要先初始化，__builtin_cpu_supports才可靠
+	if (__builtin_cpu_supports("avx2"))
+		scan_string = scan_string_avx2;
+}
+#elif defined(cJSON_USE_SSE2)
+#define scan_string scan_string_sse2
+#else
+#define scan_string scan_string_scalar
+#endif
+
+static const char *parse_string(cJSON *item, const char *str, parse_state *ps)
 {
 	const char *ptr = str + 1; // 跳过第一个匹配字符串的引号
 	char *ptr2;				   // 用于字符串赋值时存储字符串指针
 	char *out;				   // 用于存储输出字符串
+	const char *end;		   // 普通字符段的结尾
+	const char *last;		   // 结尾的双引号，没有时为输入结尾
 	int len = 0;			   // 记录字符串长度
 	unsigned uc, uc2;		   // 用于存储Unicode字符，uc2用于存储低位代理字符
-	if (*str != '\"')
-	{
-		ep = str;
-		return 0;
-	} /* 不是string，匹配失败! */
+	if (!parse_at(ps, str, '\"'))
+		return parse_fail(ps, str, cJSON_ErrorKey); /* 不是string，匹配失败! 只有对象的键名会走到这里 */
 
-	// ptr不是字符串结束的双引号 (")，不是空字符（'\0' C 语言中字符串是以空字符结尾 ）同时对字符串长度累加
-	while (*ptr != '\"' && *ptr && ++len)
-		if (*ptr++ == '\\')
+	/*
+		累加长度直到字符串结束的双引号 (")或输入结尾，普通字符成段跳过。
+		反斜杠只转义紧跟的一个字符，字符串的范围由这一条规则决定，下面反转义时不会越过last，
+		所以"\u12"这样不完整的转义也不会吞掉结尾的引号、写出超过len的内容。
+	*/
+	for (;;)
+	{
+		end = scan_string(ptr, ps->end);
+		len += (int)(end - ptr);
+		ptr = end;
+		if (ptr == ps->end || *ptr == '\"')
+			break;
+		len++;
+		if (*ptr++ == '\\' && ptr < ps->end)
 			ptr++; /* 跳过转义符 */
+	}
+	last = ptr;
 
-	out = (char *)cJSON_malloc(len + 1); /* 根据字符串长度分配内存 */
-	if (!out)
-		return 0; // 内存分配失败
+	if (ps->insitu) // 反转义后只会变短，直接写回输入缓冲区，结尾的'\0'写在右引号的位置上
+		out = (char *)str + 1;
+	else if (ps->sax) // SAX解析不保留字符串，都写到同一块缓冲区里
+	{
+		if (!(out = parse_scratch(ps, len + 1)))
+			return 0;
+	}
+	else if (!(out = (char *)parse_malloc(ps, len + 1))) /* 根据字符串长度分配内存 */
+		return 0;											 // 内存分配失败
 
 	ptr = str + 1; // 重置指针位置
 	ptr2 = out;
-	while (*ptr != '\"' && *ptr) // 将字符串有效内容复制到ptr2
+	while (ptr < last) // 将字符串有效内容复制到ptr2
 	{
-		if (*ptr != '\\') // 只要不是转义符，直接复制
+		end = scan_string(ptr, last);
+		if (end != ptr) // 普通字符成段复制
+		{
+			if (ptr2 != ptr) // 就地解析时，遇到第一个转义之前两者重合，不用搬动
+				memmove(ptr2, ptr, end - ptr);
+			ptr2 += end - ptr;
+			ptr = end;
+		}
+		else if (*ptr != '\\') // 控制字符直接复制
 			*ptr2++ = *ptr++;
 		else // 是转义符，判断转义符类型
 		{
 			ptr++; // 跳过转义符
+			if (ptr == last)
+				break; // 转义符后面就是结尾，不能再往后读
 			switch (*ptr)
 			{
 			case 'b':
@@ -347,7 +1309,12 @@ static const char *parse_string(cJSON *item, const char *str)
 			case 't':
 				*ptr2++ = '\t';
 				break;
-			case 'u':					  /* 将UTF-16转换为UTF-8. */
+			case 'u': /* 将UTF-16转换为UTF-8. */
+				if (last - ptr < 5)
+				{
+					ptr = last - 1; // 不足4位十六进制数就到了结尾，丢弃这个转义
+					break;
+				}
 				uc = parse_hex4(ptr + 1); // 将由字符串解析后的16进制数赋给uc
 				ptr += 4;				  /* 指针后移，跳过已解析字符 */
 
@@ -359,8 +1326,8 @@ static const char *parse_string(cJSON *item, const char *str)
 
 				if (uc >= 0xD800 && uc <= 0xDBFF) /* 处理 UTF16 代理对.	*/
 				{
-					if (ptr[1] != '\\' || ptr[2] != 'u') // 高位代理对
-						break;							 /* 缺少低位代理对 */
+					if (last - ptr < 7 || ptr[1] != '\\' || ptr[2] != 'u') // 高位代理对
+						break;												 /* 缺少低位代理对 */
 					uc2 = parse_hex4(ptr + 3);			 // 解析低位代理对
 					ptr += 6;							 // 指针后移，跳过已解析字符
 					if (uc2 < 0xDC00 || uc2 > 0xDFFF)
@@ -415,162 +1382,163 @@ static const char *parse_string(cJSON *item, const char *str)
 			ptr++; // 指针后移，指向下一个待处理的字符
 		}
 	}
-	*ptr2 = 0;		  // 字符串结束，将字符串结束符添加到输出字符串末尾
-	if (*ptr == '\"') // 当前解析的字符串类型结束，完整的JSON还未解析完
-		ptr++;		  // 解析下一类型，指向下一个待处理的字符
+	if (parse_at(ps, ptr, '\"')) // 当前解析的字符串类型结束，完整的JSON还未解析完
+		ptr++;					 // 解析下一类型，指向下一个待处理的字符
+	else if (ps->insitu)
+		return parse_fail(ps, str, cJSON_ErrorValue); // 就地解析时缺少右引号，没有位置写'\0'
+	*ptr2 = 0; // 字符串结束，将字符串结束符添加到输出字符串末尾（就地解析时可能正好覆盖右引号）
 	item->valuestring = out;
-	item->type = cJSON_String;
+	item->type = cJSON_String | (ps->insitu ? cJSON_InSitu : 0);
 	return ptr;
 }
 
-/* 将提供的 C 字符串转换为可以打印的转义版本。 */
-static char *print_string_ptr(const char *str, printbuffer *p)
-{
-	const char *ptr;	   // 用来遍历的指针
-	char *ptr2, *out;	   // ptr2临时指针用来赋值，out记录返回字符串
-	int len = 0, flag = 0; // len用于记录字符串长度，flag用于标记是否有特殊字符
-	unsigned char token;   // 遍历字符串时暂存字符
+/* 控制字符在反斜杠后面写的字符，'u'表示写成\u00xx */
+static const char cJSON_escapes[] = "uuuuuuuubtnufruuuuuuuuuuuuuuuuuu";
 
-	for (ptr = str; *ptr; ptr++) // 遍历字符串str检查是否有特殊字符
-		flag |= ((*ptr > 0 && *ptr < 32) || (*ptr == '\"') || (*ptr == '\\')) ? 1 : 0;
-	if (!flag) // 没有特殊字符，直接返回
-	{
-		len = ptr - str;						 // 记录字符串长度
-		if (p)									 // 有输出缓冲区
-			out = ensure(p, len + 3);			 // +3是为首尾引号和一个终结字符
-		else									 // 没有输出缓冲区
-			out = (char *)cJSON_malloc(len + 3); // 手动分配
-		if (!out)
-			return 0;	   // 内存分配失败
-		ptr2 = out;		   // ptr2指向新分配的空间
-		*ptr2++ = '\"';	   // 首引号
-		strcpy(ptr2, str); // 复制字符串
-		ptr2[len] = '\"';  // 尾引号
-		ptr2[len + 1] = 0; // 终结字符
-		return out;
-	}
+/* 字符c转义后的长度 */
+#define cJSON_ESCAPED_LEN(c) (((c) > 31 && (c) != '\"' && (c) != '\\') ? 1 : ((c) > 31 || cJSON_escapes[c] != 'u') ? 2 : 6)
+
+/*
+	将提供的 C 字符串转义后渲染进缓冲区，offset随之前进，返回写入的字节数（含两个引号），失败返回0。
+	转义和复制在同一遍里完成：缓冲区剩余的空间都可以写，放不下下一个字符时
+	才把已写的部分计入offset并调用ensure扩容，流式输出时则是交给write后从头复用。
+	每次只要求刚好放得下的空间，所以按cJSON_PrintedLength准备的缓冲区也能正好写满。
+*/
+static size_t print_string_ptr(const char *str, printbuffer *p)
+{
+	const unsigned char *ptr = (const unsigned char *)(str ? str : ""); // 空指针按空字符串输出
+	char *out, *end;	 // out是写入位置，end之后留给尾引号和终结字符
+	size_t len = 0;		 // 已经计入offset的字节数
+	int need;			 // 当前字符转义后的长度
+	unsigned char token; // 遍历字符串时暂存字符
 
-	if (!str) // 处理空指针
+	if (!(out = ensure(p, 3)))
+		return 0; // 内存分配失败
+	end = p->buffer + p->length - 2;
+	*out++ = '\"'; // 首引号
+	while ((token = *ptr++))
 	{
-		if (p)
-			out = ensure(p, 3);
-		else
-			out = (char *)cJSON_malloc(3);
-		if (!out)
-			return 0;
-		strcpy(out, "\"\""); // 复制一个只包含引号的空字符串
-		return out;
-	}
-	ptr = str; // ptr复位，计算有特殊字符时的长度
-	while ((token = *ptr) && ++len)
-	{
-		if (strchr("\"\\\b\f\n\r\t", token)) // strchr函数用于查找一个字符在字符串中首次出现的位置。
-			len++;							 // 为转义符增加额外长度
-		else if (token < 32)
-			len += 5; // 为不可见字符增加额外长度
-		ptr++;
-	}
-	// 同上
-	if (p)
-		out = ensure(p, len + 3);
-	else
-		out = (char *)cJSON_malloc(len + 3);
-	if (!out)
-		return 0; // 内存分配失败
-
-	ptr2 = out;		// ptr2指向新分配的空间
-	ptr = str;		// ptr复位，开始复制字符串
-	*ptr2++ = '\"'; // 首引号
-	while (*ptr)	// 字符串内容
-	{
-		if ((unsigned char)*ptr > 31 && *ptr != '\"' && *ptr != '\\') // 普通字符
-			*ptr2++ = *ptr++;										  // 直接复制
-		else
+		need = cJSON_ESCAPED_LEN(token);
+		if (out + need > end) // 放不下这个字符
 		{
-			*ptr2++ = '\\'; // 先加转义字符
-			switch (token = *ptr++)
-			{
-				// 连入对应的转义字符
-			case '\\':
-				*ptr2++ = '\\';
-				break;
-			case '\"':
-				*ptr2++ = '\"';
-				break;
-			case '\b':
-				*ptr2++ = 'b';
-				break;
-			case '\f':
-				*ptr2++ = 'f';
-				break;
-			case '\n':
-				*ptr2++ = 'n';
-				break;
-			case '\r':
-				*ptr2++ = 'r';
-				break;
-			case '\t':
-				*ptr2++ = 't';
-				break;
-			default:
-				sprintf(ptr2, "u%04x", token); // 特殊字符以16进制转换为unicode字符串连入输出字符串
-				ptr2 += 5;
-				break; /* escape and print */
-			}
+			len += (size_t)(out - p->buffer) - p->offset;
+			p->offset = (size_t)(out - p->buffer);
+			if (!(out = ensure(p, need + 2)))
+				return 0;
+			end = p->buffer + p->length - 2;
+		}
+		if (need == 1) // 普通字符直接复制
+			*out++ = (char)token;
+		else if (need == 2) // 引号、反斜杠和有简写的控制字符
+		{
+			*out++ = '\\';
+			*out++ = (token > 31) ? (char)token : cJSON_escapes[token];
+		}
+		else // 其余控制字符以16进制写成\u00xx
+		{
+			*out++ = '\\', *out++ = 'u', *out++ = '0', *out++ = '0';
+			*out++ = "0123456789abcdef"[token >> 4];
+			*out++ = "0123456789abcdef"[token & 15];
 		}
 	}
-	*ptr2++ = '\"'; // 尾引号
-	*ptr2++ = 0;	// 终结字符
-	return out;
+	*out++ = '\"'; // 尾引号
+	*out = 0;	   // 终结字符
+	len += (size_t)(out - p->buffer) - p->offset;
+	p->offset = (size_t)(out - p->buffer);
+	return len;
+}
+
+/* 字符串转义后的长度，不含两个引号 */
+static size_t string_length(const char *str)
+{
+	const unsigned char *ptr = (const unsigned char *)(str ? str : "");
+	size_t len = 0;
+	for (; *ptr; ptr++)
+		len += cJSON_ESCAPED_LEN(*ptr);
+	return len;
 }
 /* 对一个项调用print_string_ptr (which is useful) */
-static char *print_string(cJSON *item, printbuffer *p) { return print_string_ptr(item->valuestring, p); }
+static size_t print_string(cJSON *item, printbuffer *p) { return print_string_ptr(item->valuestring, p); }
 
 /* 预先声明这些函数原型 */
-static const char *parse_value(cJSON *item, const char *value);
-static char *print_value(cJSON *item, int depth, int fmt, printbuffer *p);
-static const char *parse_array(cJSON *item, const char *value);
-static char *print_array(cJSON *item, int depth, int fmt, printbuffer *p);
-static const char *parse_object(cJSON *item, const char *value);
-static char *print_object(cJSON *item, int depth, int fmt, printbuffer *p);
-
-/* 用于跳过空白字符以及回车换行字符的工具函数。 */
-static const char *skip(const char *in)
-{
-	// 判断输入字符串指针是否为空，以及字符串中当前字符是否为空，以及当前字符是否为不可见字符。
-	while (in && *in && (unsigned char)*in <= 32)
-		in++; // 跳过以上字符
+static const char *parse_value(cJSON *item, const char *value, parse_state *ps);
+static int print_value(cJSON *item, int fmt, printbuffer *p);
+static size_t print_length(cJSON *item, int fmt, int exact, const cJSON_Allocator *alloc);
+static const char *parse_container(cJSON *item, const char *value, parse_state *ps);
+static int vector_count(cJSON *array);
+static void vector_drop(struct cJSON_Internal *index);
+static void vector_track(cJSON *array, cJSON *item, int n);
+
+#ifdef cJSON_USE_SSE2
+/* 一次检查16个字节，返回第一个不是空白（大于32或为'\0'）的位置，没有则返回end。格式化输出里空白多是换行加几个制表符，SSE2就够用，不做AVX2分派 */
+static const char *skip_sse2(const char *in, const char *end)
+{
+	const __m128i space = _mm_set1_epi8(32), zero = _mm_setzero_si128();
+	__m128i v;
+	int mask;
+	for (; end - in >= 16; in += 16)
+	{
+		v = _mm_loadu_si128((const __m128i *)in);
+		mask = _mm_movemask_epi8(_mm_andnot_si128(_mm_cmpeq_epi8(v, zero), _mm_cmpeq_epi8(_mm_min_epu8(v, space), v))); // 1..32为空白
+		if (mask != 0xFFFF)
+			return in + __builtin_ctz(~mask);
+	}
+	while (in < end && *in && (unsigned char)*in <= 32) // 不足16字节的尾部逐个检查
+		in++;
 	return in;
 }
+#endif
 
-/* 解析一个对象 - 创建一个新的根节点，并填充数据。 */
-cJSON *cJSON_ParseWithOpts(const char *value, const char **return_parse_end, int require_null_terminated)
+/* 用于跳过空白字符以及回车换行字符的工具函数，不越过end。 */
+static const char *skip(const char *in, const char *end)
+{
+	// 判断输入字符串指针是否为空，是否已到结尾，以及当前字符是否为不可见字符。
+#ifdef cJSON_USE_SSE2
+	int n;
+#endif
+	if (!in || in == end || !*in || (unsigned char)*in > 32) // 紧凑的输入大多不需要跳过
+		return in;
+#ifdef cJSON_USE_SSE2
+	for (n = 0, in++; n < 4; n++, in++) // 短空白（逗号后的空格、换行加几层缩进）逐字节处理更快
+		if (in == end || !*in || (unsigned char)*in > 32)
+			return in;
+	return skip_sse2(in, end);
+#else
+	while (++in < end && *in && (unsigned char)*in <= 32)
+		; // 跳过以上字符
+	return in;
+#endif
+}
+
+/* 解析一个对象 - 创建一个新的根节点，并填充数据。只读取value开始的length个字节，所有状态都在ps里，可以在多个线程上同时调用 */
+static cJSON *parse_root(const char *value, size_t length, const char **return_parse_end, int require_null_terminated, parse_state *ps)
 {
 	// end用于记录解析结束时的位置。
 	const char *end = 0;
 	// 创建一个新的cJSON对象，用于返回。
-	cJSON *c = cJSON_New_Item();
-	// 初始化ep为0，ep用于记录解析过程中的错误位置。
-	ep = 0;
-	if (!c)
-		return 0;					   /* 创建失败 */
-									   // bug:创建失败后打印错误信息时，ep是空指针
-	end = parse_value(c, skip(value)); // 把解析后返回的字符串指针赋值给end。
-	if (!end)						   // 空指针说明解析失败
+	cJSON *c;
+
+	ps->start = value, ps->end = value + length, ps->ep = 0, ps->error = cJSON_ErrorNone;
+	if (!value)
+		return (cJSON *)parse_fail(ps, 0, cJSON_ErrorValue);
+	if (!(c = parse_new_item(ps)))
+		return 0;										/* 创建失败 */
+	end = parse_value(c, skip(value, ps->end), ps); // 把解析后返回的字符串指针赋值给end。
+	if (!end)										// 空指针说明解析失败
 	{
-		cJSON_Delete(c); // 释放创建失败的cJSON对象
-		return 0;		 // 返回空指针表示解析失败
+		parse_release(ps, c); // 释放创建失败的cJSON对象
+		return 0;			  // 返回空指针表示解析失败
 	}
+	parse_mark(ps, c);
 
-	/* 如果要求JSON字符串以空字符终止且没有附加的垃圾字符，则跳过后检查空终止符 */
+	/* 如果要求JSON字符串以空字符终止且没有附加的垃圾字符，则跳过后检查空终止符（或输入结尾） */
 	if (require_null_terminated)
 	{
-		end = skip(end);
-		if (*end) // 如果字符串没有以空字符终止，则释放创建的cJSON对象并返回空指针表示解析失败
+		end = skip(end, ps->end);
+		if (end < ps->end && *end) // 如果字符串没有以空字符终止，则释放创建的cJSON对象并返回空指针表示解析失败
 		{
-			cJSON_Delete(c);
-			ep = end;
-			return 0;
+			parse_release(ps, c);
+			return (cJSON *)parse_fail(ps, end, cJSON_ErrorTrailing);
 		}
 	}
 	// 如果提供了return_parse_end指针，则设置其指向解析结束的位置。
@@ -578,586 +1546,1985 @@ cJSON *cJSON_ParseWithOpts(const char *value, const char **return_parse_end, int
 		*return_parse_end = end;
 	return c;
 }
+
+/* 把解析状态里的错误换算成偏移和行列，只在出错时扫描一遍出错位置之前的输入 */
+static void parse_report(const parse_state *ps, cJSON_Error *error)
+{
+	const char *p;
+	if (!error)
+		return;
+	error->kind = ps->error;
+	error->position = ps->ep;
+	error->offset = 0, error->line = 0, error->column = 0;
+	if (!ps->ep)
+		return;
+	error->offset = (size_t)(ps->ep - ps->start);
+	error->line = 1, error->column = 1;
+	for (p = ps->start; p < ps->ep; p++)
+	{
+		if (*p == '\n')
+			error->line++, error->column = 1;
+		else
+			error->column++;
+	}
+}
+
+cJSON *cJSON_ParseWithError(const char *value, const char **return_parse_end, int require_null_terminated, cJSON_Error *error)
+{
+	parse_state ps = {0};
+	cJSON *c = parse_root(value, value ? strlen(value) : 0, return_parse_end, require_null_terminated, &ps); // 先求出长度，之后的解析都按长度判断结尾
+	parse_report(&ps, error);
+	return c;
+}
+
+cJSON *cJSON_ParseWithOpts(const char *value, const char **return_parse_end, int require_null_terminated)
+{
+	parse_state ps = {0};
+	cJSON *c = parse_root(value, value ? strlen(value) : 0, return_parse_end, require_null_terminated, &ps);
+	ep = ps.ep; // 旧接口通过cJSON_GetErrorPtr报告错误位置
+	return c;
+}
 /* cJSON_Parse的默认选项 */
 cJSON *cJSON_Parse(const char *value) { return cJSON_ParseWithOpts(value, 0, 0); }
 
-/* 将一个cJSON数据项（实体或结构）按格式渲染成文本形式。 */
-char *cJSON_Print(cJSON *item) { return print_value(item, 0, 1, 0); } // 默认调用深度为0
-/* 将一个cJSON数据项（实体或结构）不格式化渲染成文本形式。 */
-char *cJSON_PrintUnformatted(cJSON *item) { return print_value(item, 0, 0, 0); } // fmt参数为0代表不格式化
-/* 预先分配缓冲区的方式渲染cJSON数据项 */
-char *cJSON_PrintBuffered(cJSON *item, int prebuffer, int fmt)
+/* 按长度解析，不要求'\0'结尾，不读取value[length]及之后的字节 */
+cJSON *cJSON_ParseWithLengthOpts(const char *value, size_t length, const char **return_parse_end, int require_null_terminated, cJSON_Error *error)
+{
+	parse_state ps = {0};
+	cJSON *c = parse_root(value, length, return_parse_end, require_null_terminated, &ps);
+	parse_report(&ps, error);
+	return c;
+}
+
+/* 与cJSON_ParseWithLengthOpts相同，节点和字符串都从alloc分配 */
+cJSON *cJSON_ParseWithAllocator(const char *value, size_t length, const char **return_parse_end, int require_null_terminated, cJSON_Error *error, const cJSON_Allocator *alloc)
+{
+	parse_state ps = {0};
+	cJSON *c;
+	ps.alloc = alloc;
+	c = parse_root(value, length, return_parse_end, require_null_terminated, &ps);
+	parse_report(&ps, error);
+	return c;
+}
+
+cJSON *cJSON_ParseWithLength(const char *value, size_t length)
+{
+	parse_state ps = {0};
+	cJSON *c = parse_root(value, length, 0, 0, &ps);
+	ep = ps.ep;
+	return c;
+}
+
+/* 就地解析，字符串在value中反转义，键名和字符串值都指向value内部 */
+cJSON *cJSON_ParseInSituOpts(char *value, size_t length, const char **return_parse_end, int require_null_terminated, cJSON_Error *error)
+{
+	parse_state ps = {0};
+	cJSON *c;
+	ps.insitu = 1;
+	c = parse_root(value, length, return_parse_end, require_null_terminated, &ps);
+	parse_report(&ps, error);
+	return c;
+}
+
+cJSON *cJSON_ParseInSitu(char *value, size_t length)
+{
+	parse_state ps = {0};
+	cJSON *c;
+	ps.insitu = 1;
+	c = parse_root(value, length, 0, 0, &ps);
+	ep = ps.ep;
+	return c;
+}
+
+/*
+	懒解析：容器先不建成员，只用结构扫描找到配对的结尾，把这段文本的起点和长度记在节点上
+	（内部记录的span和spanlen），标记cJSON_Lazy。
+	第一次通过接口访问成员时再解析这一层，其中的子容器同样只记下范围，没访问到的子树始终不建。
+*/
+
+/* 结构扫描用的字符分类：1是引号，2是左括号，3是右括号，4是反斜杠，其余为0 */
+static const unsigned char lazy_class[256] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 4, 3, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 0, 3, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+
+/* 结构扫描：从value处的'['或'{'找到与之配对的结尾，只跟踪字符串和括号深度，不检查其余语法。返回结尾之后的位置，没有配对或嵌套超过限制时记下错误并返回0 */
+static const char *lazy_skip(const char *value, parse_state *ps)
+{
+	const char *p = value + 1, *end = ps->end;
+	int depth = 1, c;
+	while (p < end)
+	{
+		if (!(c = lazy_class[(unsigned char)*p++]))
+			continue;
+		if (c == 1) // 字符串里的括号不算，只找结尾的引号
+		{
+			c = 0;
+			while (p < end && (c = lazy_class[(unsigned char)*p++]) != 1)
+				if (c == 4)
+					p++; // 跳过被转义的字符
+			if (c != 1)
+				break;
+		}
+		else if (c == 2 && ++depth > cJSON_NESTING_LIMIT) // 展开时一层一层解析，只有这里能看到整段的嵌套深度
+			return parse_fail(ps, p - 1, cJSON_ErrorDepth);
+		else if (c == 3 && !--depth)
+			return p;
+	}
+	return parse_fail(ps, end, (*value == '[') ? cJSON_ErrorArrayEnd : cJSON_ErrorObjectEnd); /* 括号不配对 */
+}
+
+/* 把value处的容器记成未展开的节点 */
+static const char *parse_lazy(cJSON *item, const char *value, parse_state *ps)
+{
+	const char *end = lazy_skip(value, ps);
+	if (!end)
+		return 0;
+	if (!internal_new(item, 0))
+		return parse_fail(ps, 0, cJSON_ErrorMemory);
+	item->type = ((*value == '[') ? cJSON_Array : cJSON_Object) | cJSON_Lazy;
+	item->internal->span = value;
+	item->internal->spanlen = end - value;
+	return end;
+}
+
+/* 展开未展开的容器，解析出这一层成员。已经展开的直接返回1；失败时保持未展开，返回0并设置cJSON_GetErrorPtr */
+static int lazy_expand(cJSON *item)
+{
+	parse_state ps = {0};
+	const char *span;
+	int flags;
+	if (!item || !(item->type & cJSON_Lazy))
+		return 1;
+	span = item->internal->span;
+	ps.start = span, ps.end = span + item->internal->spanlen, ps.lazy = 1;
+	flags = item->type & ~(255 | cJSON_Lazy); // parse_container会改写type，键名常量等标记要保留
+	if (parse_container(item, span, &ps))
+	{
+		item->type |= flags;
+		item->internal->span = 0, item->internal->spanlen = 0;
+		if (!item->internal->items) // 懒解析用全局分配器，展开时没有建向量就不再需要记录
+		{
+			cJSON_FreeIndex(item->internal);
+			item->internal = 0;
+		}
+		return 1;
+	}
+	vector_drop(item->internal); // 向量里是已解析的部分
+	cJSON_Delete(item->child); // 丢弃已解析的部分，下次访问时再试
+	item->child = 0;
+	item->type = ((*span == '[') ? cJSON_Array : cJSON_Object) | cJSON_Lazy | flags;
+	ep = ps.ep;
+	return 0;
+}
+
+/* 懒解析：字符串、数字等标量照常解析，容器只记下范围 */
+cJSON *cJSON_ParseLazyOpts(const char *value, size_t length, const char **return_parse_end, int require_null_terminated, cJSON_Error *error)
+{
+	parse_state ps = {0};
+	cJSON *c;
+	ps.lazy = 1;
+	c = parse_root(value, length, return_parse_end, require_null_terminated, &ps);
+	parse_report(&ps, error);
+	return c;
+}
+
+cJSON *cJSON_ParseLazy(const char *value, size_t length)
+{
+	parse_state ps = {0};
+	cJSON *c;
+	ps.lazy = 1;
+	c = parse_root(value, length, 0, 0, &ps);
+	ep = ps.ep;
+	return c;
+}
+
+cJSON *cJSON_GetChild(cJSON *item) { return (item && lazy_expand(item)) ? item->child : 0; }
+
+/*
+	双阶段解析：第一阶段每次取64字节，用SSE2求出引号、反斜杠和结构字符（{}[]:,）的位掩码，
+	由反斜杠算出被转义的字符，再对引号做前缀异或得到字符串内部的掩码，
+	把不在字符串里的结构字符和所有未转义的引号按偏移顺序记入ps->tape。
+	第二阶段由parse_value/parse_container建树，ps->tape不为空时结构字符都与索引核对；字符串的两个引号都已知，
+	没有反斜杠的字符串直接按长度复制，不再扫描。数字和关键字里没有结构字符，照常解析。
+	索引与输入对不上（输入有语法错误）时第二阶段直接失败，入口函数改用逐字节解析重来，
+	所以出错信息和逐字节解析完全相同。
+*/
+
+/* 右引号条目的最高位：字符串里有反斜杠，要走parse_string反转义 */
+#define cJSON_TAPE_ESCAPED 0x80000000u
+/* 索引分段的大小（条目数），放在栈上 */
+#define cJSON_TAPE_SIZE 1024
+
+/* 一块64字节中的引号、反斜杠和结构字符，第i位对应第i个字节 */
+static void tape_masks(const char *p, unsigned long long *quote, unsigned long long *backslash, unsigned long long *op)
+{
+	int i;
+#ifdef cJSON_USE_SSE2
+	const __m128i q = _mm_set1_epi8('\"'), bs = _mm_set1_epi8('\\'), open = _mm_set1_epi8('['), close = _mm_set1_epi8(']');
+	const __m128i colon = _mm_set1_epi8(':'), comma = _mm_set1_epi8(','), fold = _mm_set1_epi8((char)0xDF); // '{'和'}'去掉0x20这一位后是'['和']'
+	__m128i v, f;
+	*quote = *backslash = *op = 0;
+	for (i = 0; i < 64; i += 16)
+	{
+		v = _mm_loadu_si128((const __m128i *)(p + i));
+		f = _mm_and_si128(v, fold);
+		*quote |= (unsigned long long)(unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(v, q)) << i;
+		*backslash |= (unsigned long long)(unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(v, bs)) << i;
+		*op |= (unsigned long long)(unsigned)_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(f, open), _mm_cmpeq_epi8(f, close)),
+																		   _mm_or_si128(_mm_cmpeq_epi8(v, colon), _mm_cmpeq_epi8(v, comma))))
+			   << i;
+	}
+#else
+	*quote = *backslash = *op = 0;
+	for (i = 0; i < 64; i++)
+	{
+		if (p[i] == '\"')
+			*quote |= 1ull << i;
+		else if (p[i] == '\\')
+			*backslash |= 1ull << i;
+		else if ((p[i] & 0xDF) == '[' || (p[i] & 0xDF) == ']' || p[i] == ':' || p[i] == ',')
+			*op |= 1ull << i;
+	}
+#endif
+}
+
+/* 前缀异或：第i位是x的第0到i位的异或，左引号到右引号之前的位都为1 */
+static unsigned long long prefix_xor(unsigned long long x)
+{
+	x ^= x << 1;
+	x ^= x << 2;
+	x ^= x << 4;
+	x ^= x << 8;
+	x ^= x << 16;
+	x ^= x << 32;
+	return x;
+}
+
+/* 第一阶段：从ps->tapepos起继续扫描，把索引填到放满为止（每块最多64个条目）或输入结束，返回是否有新条目。
+   索引不一次建完，而是随第二阶段的进度分段填写，索引和刚扫描过的输入都还在缓存里 */
+static int tape_fill(parse_state *ps)
+{
+	size_t length = ps->end - ps->start, pos;
+	unsigned long long quote, backslash, op, escaped, bits, bs, mask;
+	const char *p;
+	char block[64];
+	int i, open = -1; // 本块中未闭合的左引号
+
+	ps->tapecount = ps->tapenext = 0;
+	for (pos = ps->tapepos; pos < length && ps->tapecount <= cJSON_TAPE_SIZE - 64; pos += 64)
+	{
+		p = ps->start + pos;
+		if (length - pos < 64) // 不足一块的尾部补0，'\0'不是任何特殊字符
+		{
+			memset(block, 0, sizeof(block));
+			memcpy(block, p, length - pos);
+			p = block;
+		}
+		tape_masks(p, &quote, &backslash, &op);
+
+		/* 反斜杠转义紧跟的一个字符，从低位起逐个处理，被转义的反斜杠不再转义别的字符 */
+		escaped = ps->tapecarry, ps->tapecarry = 0;
+		for (bs = backslash & ~escaped; bs; bs &= ~(3ull << i))
+		{
+			i = ctz_64(bs);
+			if (i == 63)
+				ps->tapecarry = 1; // 被转义的是下一块的第一个字节
+			else
+				escaped |= 2ull << i;
+		}
+		quote &= ~escaped;
+		mask = prefix_xor(quote) ^ ps->tapestring;
+		ps->tapestring = (mask >> 63) ? ~0ull : 0;
+
+		for (bits = (op & ~mask) | quote; bits; bits &= bits - 1)
+		{
+			i = ctz_64(bits);
+			if (!((quote >> i) & 1))
+				ps->tape[ps->tapecount++] = (unsigned)(pos + i);
+			else if ((mask >> i) & 1) // 左引号
+			{
+				ps->tape[ps->tapecount++] = (unsigned)(pos + i);
+				open = i, ps->tapeescaped = 0;
+			}
+			else // 右引号，检查两个引号之间有没有反斜杠
+			{
+				bs = backslash & ((1ull << i) - 1);
+				if (open >= 0)
+					bs &= ~((2ull << open) - 1);
+				ps->tape[ps->tapecount++] = (unsigned)(pos + i) | ((bs || ps->tapeescaped) ? cJSON_TAPE_ESCAPED : 0);
+				open = -1;
+			}
+		}
+		if (ps->tapestring) // 字符串延续到下一块
+		{
+			bs = backslash;
+			if (open >= 0)
+				bs &= ~((2ull << open) - 1);
+			ps->tapeescaped |= (bs != 0);
+			open = -1;
+		}
+	}
+	ps->tapepos = pos;
+	return ps->tapecount != 0;
+}
+
+/* 核对下一个索引条目正好位于p处，并消耗它 */
+static int tape_at(parse_state *ps, const char *p)
+{
+	if (ps->tapenext == ps->tapecount && !tape_fill(ps))
+		return 0;
+	if (ps->start + (ps->tape[ps->tapenext] & ~cJSON_TAPE_ESCAPED) != p)
+		return 0;
+	ps->tapenext++;
+	return 1;
+}
+
+/* 按索引中的两个引号解析字符串 */
+static const char *tape_string(cJSON *item, const char *str, parse_state *ps)
+{
+	const char *close;
+	unsigned e;
+	size_t len;
+	char *out;
+	if (!parse_at(ps, str, '\"') || !tape_at(ps, str) || (ps->tapenext == ps->tapecount && !tape_fill(ps)))
+		return 0;
+	e = ps->tape[ps->tapenext++];
+	close = ps->start + (e & ~cJSON_TAPE_ESCAPED);
+	if (*close != '\"')
+		return 0;
+	if (e & cJSON_TAPE_ESCAPED)
+		return (parse_string(item, str, ps) == close + 1) ? close + 1 : 0;
+	len = close - str - 1;
+	if (!(out = (char *)parse_malloc(ps, len + 1)))
+		return 0;
+	memcpy(out, str + 1, len);
+	out[len] = 0;
+	item->valuestring = out;
+	item->type = cJSON_String;
+	return close + 1;
+}
+
+/* 双阶段解析的根，与parse_root相同，失败时不记录错误 */
+static cJSON *tape_root(const char *value, size_t length, const char **return_parse_end, int require_null_terminated, parse_state *ps)
+{
+	unsigned tape[cJSON_TAPE_SIZE];
+	const char *end = 0;
+	cJSON *c;
+	if (!value || length >= cJSON_TAPE_ESCAPED) // 偏移放不进31位
+		return 0;
+	ps->start = value, ps->end = value + length, ps->tape = tape;
+	if ((c = parse_new_item(ps)) && (!(end = parse_value(c, skip(value, ps->end), ps)) || (require_null_terminated && (end = skip(end, ps->end)) < ps->end && *end)))
+	{
+		parse_release(ps, c);
+		c = 0;
+	}
+	if (c && return_parse_end)
+		*return_parse_end = end;
+	return c;
+}
+
+/* 双阶段解析，失败时用逐字节解析重来，得到与cJSON_ParseWithLengthOpts相同的错误信息 */
+cJSON *cJSON_ParseIndexedOpts(const char *value, size_t length, const char **return_parse_end, int require_null_terminated, cJSON_Error *error)
+{
+	parse_state ps = {0};
+	cJSON *c = tape_root(value, length, return_parse_end, require_null_terminated, &ps);
+	if (!c)
+	{
+		memset(&ps, 0, sizeof(ps));
+		c = parse_root(value, length, return_parse_end, require_null_terminated, &ps);
+	}
+	parse_report(&ps, error);
+	return c;
+}
+
+cJSON *cJSON_ParseIndexed(const char *value, size_t length)
+{
+	parse_state ps = {0};
+	cJSON *c = tape_root(value, length, 0, 0, &ps);
+	if (!c)
+	{
+		memset(&ps, 0, sizeof(ps));
+		c = parse_root(value, length, 0, 0, &ps);
+	}
+	ep = ps.ep;
+	return c;
+}
+
+/* 在arena中解析，arena为空时新建一个由根节点独占的arena */
+cJSON *cJSON_ParseInArena(const char *value, cJSON_Arena *arena)
+{
+	parse_state ps = {0};
+	cJSON *c;
+
+	if (!arena && !(ps.arena = cJSON_CreateArena(0)))
+		return 0;
+	if (arena)
+		ps.arena = arena;
+	c = parse_root(value, value ? strlen(value) : 0, 0, 0, &ps); // 新建的arena中第一个分配的就是根节点，cJSON_ArenaOf据此反推
+	ep = ps.ep;
+	if (arena)
+		return c;
+	if (!c)
+		cJSON_DeleteArena(ps.arena); // 解析失败，连同arena一起释放
+	else
+		c->type |= cJSON_ArenaOwner;
+	return c;
+}
+
+/*
+	增量解析：输入分成任意大小的块依次送入，状态保存在cJSON_Push里。
+	容器的嵌套用显式的栈记录；字符串、数字和关键字如果被块边界截断，已收到的部分先存进tok，
+	凑齐后交给parse_string/parse_number，所以得到的树和出错位置都与一次性解析相同。
+	没有被截断的记号直接在输入块上解析，不复制。
+*/
+#define PUSH_VALUE 0		// 期待一个值
+#define PUSH_ARRAY_FIRST 1	// '['之后，期待值或']'
+#define PUSH_OBJECT_FIRST 2 // '{'之后，期待键名或'}'
+#define PUSH_KEY 3			// 对象中','之后，期待键名
+#define PUSH_COLON 4		// 键名之后，期待':'
+#define PUSH_AFTER 5		// 容器中的值之后，期待','或右括号
+#define PUSH_DONE 6			// 根节点已完成
+#define PUSH_STOP 7			// 出错，或要求'\0'结尾时遇到了'\0'，之后的输入一律忽略
+
+#define PUSH_TOKEN_NONE 0
+#define PUSH_TOKEN_STRING 1
+#define PUSH_TOKEN_NUMBER 2
+#define PUSH_TOKEN_KEYWORD 3
+
+struct cJSON_Push
+{
+	cJSON *root;			// 根节点，没有交给调用者之前由cJSON_PushDelete释放
+	cJSON **stack;			// 尚未闭合的数组和对象
+	int depth, size;		// 栈深度和容量
+	int members;			// 栈顶容器已有的成员数，自动建向量用
+	int state;				// PUSH_*之一
+	int require_null_terminated;
+	int token;				// 被块边界截断的记号种类，PUSH_TOKEN_*之一
+	int is_key;				// 截断的字符串是键名
+	int escaped;			// 截断的字符串以未配对的反斜杠结尾
+	const char *keyword;	// 正在匹配的关键字
+	cJSON *item;			// 正在填充的节点，在对象中也是等待值的键名节点
+	char *tok;				// 截断的字符串或数字已收到的部分
+	size_t toklen, tokcap;	// tok的长度和容量，匹配关键字时toklen是已匹配的字符数
+	size_t tokstart;		// 截断的记号在整个输入中的偏移
+	size_t offset;			// 当前块之前已收到的字节数
+	size_t line, linestart; // 当前块开头所在的行号和该行起点的偏移
+	int error;				// 错误类型
+	size_t ep;				// 出错位置在整个输入中的偏移
+	int epline, epcolumn;	// 出错位置的行列
+	parse_state ps;			// 调用parse_string等函数时用，只用到end和内存错误
+};
+
+cJSON_Push *cJSON_PushCreate(int require_null_terminated)
+{
+	cJSON_Push *push = (cJSON_Push *)cJSON_malloc(sizeof(cJSON_Push));
+	if (push)
+	{
+		memset(push, 0, sizeof(cJSON_Push));
+		push->require_null_terminated = require_null_terminated;
+		push->line = 1;
+	}
+	return push;
+}
+
+void cJSON_PushDelete(cJSON_Push *push)
+{
+	if (!push)
+		return;
+	cJSON_Delete(push->root);
+	if (push->stack)
+		cJSON_free(push->stack);
+	if (push->tok)
+		cJSON_free(push->tok);
+	cJSON_free(push);
+}
+
+/*
+	记录第一个错误，返回0。at是出错字节在整个输入中的偏移，chunk是当前块（没有时为0）。
+	at在当前块之前时它位于被截断的关键字或数字中间，和当前块开头在同一行。
+*/
+static const char *push_fail(cJSON_Push *push, const char *chunk, size_t at, int error)
+{
+	size_t line = push->line, linestart = push->linestart, i;
+	push->state = PUSH_STOP;
+	if (push->error)
+		return 0;
+	if (error == cJSON_ErrorMemory || push->ps.error == cJSON_ErrorMemory)
+	{
+		push->error = cJSON_ErrorMemory; // 和一次性解析一样，内存错误没有位置
+		return 0;
+	}
+	for (i = push->offset; chunk && i < at; i++)
+		if (chunk[i - push->offset] == '\n')
+			line++, linestart = i + 1;
+	push->error = error, push->ep = at;
+	push->epline = (int)line, push->epcolumn = (int)(at - linestart + 1);
+	return 0;
+}
+
+/* 把块中的一段追加到tok */
+static int push_append(cJSON_Push *push, const char *p, size_t len)
+{
+	char *tok;
+	size_t cap;
+	if (push->toklen + len > push->tokcap)
+	{
+		for (cap = push->tokcap ? push->tokcap : 64; cap < push->toklen + len; cap *= 2)
+			;
+		if (!(tok = (char *)cJSON_grow(0, push->tok, push->toklen, cap)))
+			return 0;
+		push->tok = tok, push->tokcap = cap;
+	}
+	memcpy(push->tok + push->toklen, p, len);
+	push->toklen += len;
+	return 1;
+}
+
+/* 一个值完成之后，根节点完成或回到所在的容器 */
+static void push_value_done(cJSON_Push *push) { push->state = push->depth ? PUSH_AFTER : PUSH_DONE; }
+
+/* 在栈顶容器的末尾（或作为根节点）新建一个节点 */
+static cJSON *push_new_item(cJSON_Push *push)
+{
+	cJSON *item = parse_new_item(&push->ps), *parent;
+	if (!item)
+		return 0;
+	if (!push->depth)
+		return push->root = item;
+	if (!(parent = push->stack[push->depth - 1])->child)
+		parent->child = item, item->prev = item; // 首元素的prev指向尾元素
+	else
+	{
+		parent->child->prev->next = item; // 接在尾元素之后
+		item->prev = parent->child->prev;
+		parent->child->prev = item;
+	}
+	vector_track(parent, item, ++push->members);
+	return item;
+}
+
+/* 容器入栈 */
+static int push_open(cJSON_Push *push, cJSON *item)
+{
+	cJSON **stack;
+	int size;
+	if (push->depth == push->size)
+	{
+		size = push->size ? push->size * 2 : 16;
+		if (!(stack = (cJSON **)cJSON_grow(0, push->stack, push->depth * sizeof(cJSON *), size * sizeof(cJSON *))))
+			return 0;
+		push->stack = stack, push->size = size;
+	}
+	push->stack[push->depth++] = item;
+	push->members = 0;
+	return 1;
+}
+
+/* 栈顶容器是不是数组 */
+static int push_in_array(cJSON_Push *push) { return (push->stack[push->depth - 1]->type & 255) == cJSON_Array; }
+
+/*
+	从p开始找当前字符串或数字记号的结尾，找到时返回记号之后的位置，记号延续到下一块时返回0。
+	字符串的范围和parse_string一样只由“反斜杠转义紧跟的一个字符”决定，数字则收下所有可能属于数字的字符。
+*/
+static const char *push_scan(cJSON_Push *push, const char *p, const char *end)
+{
+	if (push->token == PUSH_TOKEN_NUMBER)
+	{
+		while (p < end && ((*p >= '0' && *p <= '9') || *p == '-' || *p == '+' || *p == '.' || *p == 'e' || *p == 'E'))
+			p++;
+		return (p < end) ? p : 0;
+	}
+	if (push->escaped && p < end)
+		p++, push->escaped = 0;
+	for (;;)
+	{
+		p = scan_string(p, end);
+		if (p == end)
+			return 0;
+		if (*p == '\"')
+			return p + 1;
+		if (*p++ == '\\')
+		{
+			if (p == end)
+			{
+				push->escaped = 1;
+				return 0;
+			}
+			p++;
+		}
+	}
+}
+
+/* 字符串或数字记号解析完之后：键名移到string；数字后面parse_number没用完的字符（从偏移rest开始，没有时为0），一次性解析时就是紧跟在值后面的字符 */
+static const char *push_finish(cJSON_Push *push, const char *chunk, const char *next, size_t rest)
+{
+	cJSON *item = push->item;
+	push->token = PUSH_TOKEN_NONE, push->toklen = 0;
+	if (push->is_key)
+	{
+		item->string = item->valuestring;
+		item->valuestring = 0;
+		push->is_key = 0;
+		push->state = PUSH_COLON;
+		return next;
+	}
+	push_value_done(push);
+	if (rest && push->depth)
+		return push_fail(push, chunk, rest, push_in_array(push) ? cJSON_ErrorArrayEnd : cJSON_ErrorObjectEnd);
+	if (rest && push->require_null_terminated)
+		return push_fail(push, chunk, rest, cJSON_ErrorTrailing);
+	return next;
+}
+
+/* 解析tok中凑齐的记号，next是块中接着处理的位置 */
+static const char *push_token(cJSON_Push *push, const char *chunk, const char *next)
+{
+	const char *end = push->tok + push->toklen, *r;
+	push->ps.end = end;
+	r = (push->token == PUSH_TOKEN_STRING) ? parse_string(push->item, push->tok, &push->ps) : parse_number(push->item, push->tok, &push->ps);
+	if (!r)
+		return push_fail(push, chunk, 0, cJSON_ErrorMemory);
+	return push_finish(push, chunk, next, (r < end) ? push->tokstart + (r - push->tok) : 0);
+}
+
+/* 继续被截断的记号，返回块中接着处理的位置 */
+static const char *push_continue(cJSON_Push *push, const char *chunk, const char *p, const char *end)
+{
+	const char *q;
+	if (push->token == PUSH_TOKEN_KEYWORD) // 关键字逐个字符比较，不需要缓存
+	{
+		for (; p < end && push->keyword[push->toklen]; p++, push->toklen++)
+			if (*p != push->keyword[push->toklen])
+				return push_fail(push, chunk, push->tokstart, cJSON_ErrorValue);
+		if (!push->keyword[push->toklen])
+		{
+			push->token = PUSH_TOKEN_NONE, push->toklen = 0;
+			push_value_done(push);
+		}
+		return p;
+	}
+	q = push_scan(push, p, end);
+	if (!push_append(push, p, (q ? q : end) - p))
+		return push_fail(push, chunk, 0, cJSON_ErrorMemory);
+	if (!q)
+		return end; // 记号还没结束，等下一块
+	return push_token(push, chunk, q);
+}
+
+/* 在p处开始一个值或键名 */
+static const char *push_begin(cJSON_Push *push, const char *chunk, const char *p, const char *end, int is_key)
+{
+	size_t at = push->offset + (p - chunk);
+	const char *r, *q;
+	cJSON *item;
+
+	if (is_key ? (*p != '\"') : (*p != '\"' && *p != '-' && (*p < '0' || *p > '9') && *p != 't' && *p != 'f' && *p != 'n' && *p != '[' && *p != '{'))
+		return push_fail(push, chunk, at, is_key ? cJSON_ErrorKey : cJSON_ErrorValue);
+	if (!is_key && push->depth && !push_in_array(push))
+		item = push->item; // 对象成员的值和键名在同一个节点上
+	else if (!(item = push_new_item(push)))
+		return push_fail(push, chunk, at, cJSON_ErrorMemory);
+	push->item = item, push->is_key = is_key, push->tokstart = at;
+	if (*p == '[' || *p == '{')
+	{
+		if (push->depth == cJSON_NESTING_LIMIT)
+			return push_fail(push, chunk, at, cJSON_ErrorDepth);
+		item->type = (*p == '[') ? cJSON_Array : cJSON_Object;
+		if (!push_open(push, item))
+			return push_fail(push, chunk, at, cJSON_ErrorMemory);
+		push->state = (*p == '[') ? PUSH_ARRAY_FIRST : PUSH_OBJECT_FIRST;
+		return p + 1;
+	}
+	if (*p == 't' || *p == 'f' || *p == 'n')
+	{
+		push->keyword = (*p == 't') ? "true" : (*p == 'f') ? "false" : "null";
+		item->type = (*p == 't') ? cJSON_True : (*p == 'f') ? cJSON_False : cJSON_NULL;
+		item->valueint = (*p == 't');
+		push->token = PUSH_TOKEN_KEYWORD;
+		return push_continue(push, chunk, p, end);
+	}
+
+	/* 先直接在块上解析，记号在块内结束（数字后面还跟着不属于数字的字符）时结果就是最终的 */
+	push->token = (*p == '\"') ? PUSH_TOKEN_STRING : PUSH_TOKEN_NUMBER;
+	push->ps.end = end;
+	r = (*p == '\"') ? parse_string(item, p, &push->ps) : parse_number(item, p, &push->ps);
+	if (!r)
+		return push_fail(push, chunk, at, cJSON_ErrorMemory);
+	if (*p == '\"')
+		q = (r < end) ? r : push_scan(push, p + 1, end); // 读到块尾时要看最后一个引号是不是被转义了，顺便记下结尾是不是未配对的反斜杠
+	else
+		q = (r < end) ? push_scan(push, r, end) : 0;
+	if (q)
+		return push_finish(push, chunk, r, (q > r) ? at + (r - p) : 0);
+
+	/* 记号延续到下一块，丢掉这次的结果，凑齐后再解析 */
+	if (*p == '\"')
+	{
+		cJSON_free(item->valuestring);
+		item->valuestring = 0;
+	}
+	if (!push_append(push, p, end - p))
+		return push_fail(push, chunk, at, cJSON_ErrorMemory);
+	return end;
+}
+
+/* p处是一个非空白字符，按当前状态处理它 */
+static const char *push_step(cJSON_Push *push, const char *chunk, const char *p, const char *end)
+{
+	size_t at = push->offset + (p - chunk);
+	switch (push->state)
+	{
+	case PUSH_ARRAY_FIRST:
+		if (*p == ']')
+			break;
+		return push_begin(push, chunk, p, end, 0);
+	case PUSH_VALUE:
+		return push_begin(push, chunk, p, end, 0);
+	case PUSH_OBJECT_FIRST:
+		if (*p == '}')
+			break;
+		return push_begin(push, chunk, p, end, 1);
+	case PUSH_KEY:
+		return push_begin(push, chunk, p, end, 1);
+	case PUSH_COLON:
+		if (*p != ':')
+			return push_fail(push, chunk, at, cJSON_ErrorColon);
+		push->state = PUSH_VALUE;
+		return p + 1;
+	case PUSH_AFTER:
+		if (*p == ',')
+		{
+			push->state = push_in_array(push) ? PUSH_VALUE : PUSH_KEY;
+			return p + 1;
+		}
+		if (*p != (push_in_array(push) ? ']' : '}'))
+			return push_fail(push, chunk, at, push_in_array(push) ? cJSON_ErrorArrayEnd : cJSON_ErrorObjectEnd);
+		break;
+	default: // PUSH_DONE，要求'\0'结尾
+		if (*p)
+			return push_fail(push, chunk, at, cJSON_ErrorTrailing);
+		push->state = PUSH_STOP; // '\0'之后的内容不再解析
+		return end;
+	}
+	if (--push->depth) // 右括号，容器闭合
+		push->members = vector_count(push->stack[push->depth - 1]);
+	push_value_done(push);
+	return p + 1;
+}
+
+int cJSON_PushFeed(cJSON_Push *push, const char *chunk, size_t length)
+{
+	const char *p = chunk, *end = chunk + length, *nl;
+
+	if (!push || push->error || (!chunk && length))
+		return 0;
+	if (!length)
+		return 1;
+	while (p && p < end && push->state != PUSH_STOP)
+	{
+		if (push->token)
+			p = push_continue(push, chunk, p, end);
+		else if (push->state == PUSH_DONE && !push->require_null_terminated)
+			break; // 和一次性解析一样，不检查根节点之后的内容
+		else if ((unsigned char)(*p - 1) >= 32 || (p = skip(p, end)) < end) // 紧凑的输入大多没有空白，先看一个字符
+			p = push_step(push, chunk, p, end);
+	}
+	if (!p)
+		return 0;
+	for (nl = chunk; (nl = (const char *)memchr(nl, '\n', end - nl)); nl++) // 记下行号，出错时换算行列
+		push->line++, push->linestart = push->offset + (nl - chunk) + 1;
+	push->offset += length;
+	return 1;
+}
+
+cJSON *cJSON_PushFinish(cJSON_Push *push, cJSON_Error *error)
+{
+	cJSON *c = 0;
+	int kind = cJSON_ErrorNone;
+
+	if (!push)
+		return 0;
+	if (!push->error && push->token == PUSH_TOKEN_KEYWORD) // 输入在记号中间结束
+		push_fail(push, 0, push->tokstart, cJSON_ErrorValue);
+	else if (!push->error && push->token)
+		push_token(push, 0, 0);
+	switch (push->state) // 输入结束时还在等待的内容，就是一次性解析在结尾处报告的错误
+	{
+	case PUSH_VALUE:
+	case PUSH_ARRAY_FIRST:
+		kind = cJSON_ErrorValue;
+		break;
+	case PUSH_OBJECT_FIRST:
+	case PUSH_KEY:
+		kind = cJSON_ErrorKey;
+		break;
+	case PUSH_COLON:
+		kind = cJSON_ErrorColon;
+		break;
+	case PUSH_AFTER:
+		kind = push_in_array(push) ? cJSON_ErrorArrayEnd : cJSON_ErrorObjectEnd;
+		break;
+	}
+	if (kind)
+		push_fail(push, 0, push->offset, kind);
+	if (error)
+	{
+		memset(error, 0, sizeof(cJSON_Error));
+		error->kind = push->error;
+		if (push->error && push->error != cJSON_ErrorMemory)
+			error->offset = push->ep, error->line = push->epline, error->column = push->epcolumn;
+	}
+	if (!push->error)
+		c = push->root, push->root = 0;
+	cJSON_PushDelete(push);
+	return c;
+}
+
+/*
+	SAX解析：不建树，按读到的顺序调用cJSON_Sax里的回调。字符串和数字仍由parse_string/parse_number解析，
+	结果放在栈上的临时节点里，字符串反转义到可复用的scratch中，所以每个值都不分配内存。
+	语法检查和出错位置与建树的解析完全相同，回调返回0时以cJSON_ErrorAborted结束。
+*/
+/* 回调的结果：ok为0时在at处中止，否则继续从next解析 */
+static const char *sax_event(parse_state *ps, const char *at, const char *next, int ok) { return ok ? next : parse_fail(ps, at, cJSON_ErrorAborted); }
+
+/* 解析一个标量并报告，与parse_value的判断顺序相同 */
+static const char *sax_scalar(const char *value, parse_state *ps, const cJSON_Sax *sax, void *ctx)
+{
+	cJSON item; // 字符串和数字的临时节点，只用到值字段
+	const char *next;
+	if (value == ps->end)
+		return parse_fail(ps, value, cJSON_ErrorValue);
+	if (ps->end - value >= 4 && !memcmp(value, "null", 4))
+		return sax_event(ps, value, value + 4, !sax->null || sax->null(ctx));
+	if (ps->end - value >= 5 && !memcmp(value, "false", 5))
+		return sax_event(ps, value, value + 5, !sax->boolean || sax->boolean(ctx, 0));
+	if (ps->end - value >= 4 && !memcmp(value, "true", 4))
+		return sax_event(ps, value, value + 4, !sax->boolean || sax->boolean(ctx, 1));
+	if (*value == '\"')
+	{
+		if (!(next = parse_string(&item, value, ps)))
+			return 0;
+		return sax_event(ps, value, next, !sax->string || sax->string(ctx, item.valuestring));
+	}
+	if (*value == '-' || (*value >= '0' && *value <= '9'))
+	{
+		if (!(next = parse_number(&item, value, ps)))
+			return 0;
+		return sax_event(ps, value, next, !sax->number || sax->number(ctx, item.valuedouble, item.valueint64));
+	}
+	return parse_fail(ps, value, cJSON_ErrorValue);
+}
+
+/*
+	解析一个值并报告。与parse_container一样，嵌套的数组和对象压入显式栈而不是递归；
+	SAX不建节点，栈里放的是标记数组和对象的两个临时节点之一。对象的每个成员先报告键名再报告值。
+*/
+static const char *sax_value(const char *value, parse_state *ps, const cJSON_Sax *sax, void *ctx)
+{
+	cJSON key, mark[2]; // 键名的临时节点；mark[0]标记数组，mark[1]标记对象
+	cJSON *parent;
+	walk_stack stack;
+	const char *next;
+	int last; // parent里已经有成员
+	mark[0].type = cJSON_Array, mark[1].type = cJSON_Object;
+	stack_init(&stack, ps->alloc);
+	for (;;)
+	{
+		if (parse_at(ps, value, '[') || parse_at(ps, value, '{'))
+		{
+			if (stack.depth == cJSON_NESTING_LIMIT)
+				return stack_done(&stack, parse_fail(ps, value, cJSON_ErrorDepth));
+			if ((*value == '[') ? (sax->start_array && !sax->start_array(ctx)) : (sax->start_object && !sax->start_object(ctx)))
+				return stack_done(&stack, parse_fail(ps, value, cJSON_ErrorAborted));
+			if (!stack_push(&stack, &mark[*value == '{']))
+				return stack_done(&stack, parse_fail(ps, 0, cJSON_ErrorMemory));
+			parent = stack.items[stack.depth - 1], last = 0;
+			value = skip(value + 1, ps->end); // 跳过左括号和空白字符
+		}
+		else
+		{
+			if (!(next = sax_scalar(value, ps, sax, ctx)) || !stack.depth)
+				return stack_done(&stack, next);
+			parent = stack.items[stack.depth - 1], last = 1;
+			value = skip(next, ps->end);
+		}
+
+		/* 逗号之后接着解析下一个成员，右括号结束容器 */
+		for (;;)
+		{
+			if (last && parse_at(ps, value, ','))
+			{
+				value = skip(value + 1, ps->end);
+				break;
+			}
+			if (!parse_at(ps, value, close_of(parent)))
+			{
+				if (!last)
+					break;
+				return stack_done(&stack, parse_fail(ps, value, (parent == mark) ? cJSON_ErrorArrayEnd : cJSON_ErrorObjectEnd));
+			}
+			if ((parent == mark) ? (sax->end_array && !sax->end_array(ctx)) : (sax->end_object && !sax->end_object(ctx)))
+				return stack_done(&stack, parse_fail(ps, value, cJSON_ErrorAborted));
+			if (!--stack.depth)
+				return stack_done(&stack, value + 1);
+			parent = stack.items[stack.depth - 1], last = 1;
+			value = skip(value + 1, ps->end);
+		}
+
+		if (parent != mark) // 对象成员先报告键名
+		{
+			if (!(next = parse_string(&key, value, ps)))
+				return stack_done(&stack, 0);
+			if (sax->key && !sax->key(ctx, key.valuestring))
+				return stack_done(&stack, parse_fail(ps, value, cJSON_ErrorAborted));
+			value = skip(next, ps->end);
+			if (!parse_at(ps, value, ':'))
+				return stack_done(&stack, parse_fail(ps, value, cJSON_ErrorColon));
+			value = skip(value + 1, ps->end);
+		}
+	}
+}
+
+int cJSON_ParseSax(const char *value, size_t length, int require_null_terminated, const cJSON_Sax *sax, void *ctx, cJSON_Error *error)
+{
+	parse_state ps = {0};
+	const char *end;
+	ps.sax = 1;
+	if (!value || !sax)
+		parse_fail(&ps, 0, cJSON_ErrorValue);
+	else
+	{
+		ps.start = value, ps.end = value + length;
+		end = sax_value(skip(value, ps.end), &ps, sax, ctx);
+		if (end && require_null_terminated)
+		{
+			end = skip(end, ps.end);
+			if (end < ps.end && *end) // 与parse_root相同，值后面只允许空白或'\0'
+				parse_fail(&ps, end, cJSON_ErrorTrailing);
+		}
+	}
+	if (ps.scratch)
+		mem_free(ps.alloc, ps.scratch);
+	parse_report(&ps, error);
+	return !ps.error;
+}
+
+/*
+	JSON Lines批量解析：先按换行切出记录（JSON Lines的记录内部不会有未转义的换行），
+	再由多个线程每次领取一批记录，各自调用parse_root解析。解析状态都在各自的栈上，线程之间只共享领取的位置。
+*/
+
+/* 每次领取的记录数，太少时加锁的开销明显，太多时线程之间负载不均 */
+#define cJSON_LINES_BATCH 64
+
+/* JSON Lines中的一条记录 */
+typedef struct
+{
+	const char *start; // 记录的起点
+	size_t length;	   // 记录的长度，不含换行符
+	size_t line;	   // 所在的行号，从1开始
+} lines_record;
+
+/* 一次批量解析的共享状态 */
+typedef struct
+{
+	const char *value;	   // 整个输入，用来把出错偏移换算到输入起点
+	lines_record *records; // 所有非空的记录
+	size_t count;		   // 记录数
+	size_t next;		   // 下一批记录的起点
+	int stop;			   // 回调要求停止
+	cJSON_LineFn fn;
+	void *ctx;
+#ifdef cJSON_USE_THREADS
+	pthread_mutex_t lock; // 保护next和stop
+#endif
+} lines_job;
+
+/* 按换行切分记录，跳过空行（包括只有'\r'的行），内存不足时返回0 */
+static int lines_split(lines_job *job, const char *value, size_t length)
+{
+	const char *p = value, *end = value + length, *nl;
+	size_t n = 1, line = 1;
+
+	job->value = value;
+	for (nl = p; (nl = (const char *)memchr(nl, '\n', end - nl)); nl++) // 先数出行数，一次分配够
+		n++;
+	if (!(job->records = (lines_record *)cJSON_malloc(n * sizeof(lines_record))))
+		return 0;
+	for (; p < end; p = nl + 1, line++)
+	{
+		if (!(nl = (const char *)memchr(p, '\n', end - p)))
+			nl = end;
+		if (nl - p > 1 || (nl - p == 1 && *p != '\r'))
+		{
+			job->records[job->count].start = p;
+			job->records[job->count].length = nl - p;
+			job->records[job->count++].line = line;
+		}
+	}
+	return 1;
+}
+
+/* 领取下一批记录，返回领到的条数，没有了或者要停止时返回0 */
+static size_t lines_take(lines_job *job, size_t *first)
+{
+	size_t n = 0;
+#ifdef cJSON_USE_THREADS
+	pthread_mutex_lock(&job->lock);
+#endif
+	if (!job->stop && job->next < job->count)
+	{
+		*first = job->next;
+		n = (job->count - job->next < cJSON_LINES_BATCH) ? job->count - job->next : cJSON_LINES_BATCH;
+		job->next += n;
+	}
+#ifdef cJSON_USE_THREADS
+	pthread_mutex_unlock(&job->lock);
+#endif
+	return n;
+}
+
+static void lines_stop(lines_job *job)
+{
+#ifdef cJSON_USE_THREADS
+	pthread_mutex_lock(&job->lock);
+#endif
+	job->stop = 1;
+#ifdef cJSON_USE_THREADS
+	pthread_mutex_unlock(&job->lock);
+#endif
+}
+
+/* 工作线程：逐条解析领到的记录，结果交给回调 */
+static void *lines_worker(void *arg)
+{
+	lines_job *job = (lines_job *)arg;
+	lines_record *r;
+	parse_state ps;
+	cJSON_Error error;
+	cJSON *c;
+	size_t first, n, i;
+
+	while ((n = lines_take(job, &first)))
+		for (i = first; i < first + n; i++)
+		{
+			r = &job->records[i];
+			memset(&ps, 0, sizeof(ps));
+			c = parse_root(r->start, r->length, 0, 1, &ps); // 记录后面只允许空白
+			parse_report(&ps, &error);
+			if (error.line) // 偏移换算到整个输入，行号换成记录所在的行
+				error.offset += (size_t)(r->start - job->value), error.line = (int)r->line;
+			if (!job->fn(job->ctx, i, c, &error))
+			{
+				lines_stop(job);
+				break;
+			}
+		}
+	return 0;
+}
+
+/* 用threads个线程（含调用线程）解析已切分好的记录，threads不大于0时取CPU核数 */
+static int lines_run(lines_job *job, int threads)
+{
+#ifdef cJSON_USE_THREADS
+	pthread_t *tid = 0;
+	int started = 0, i;
+	size_t batches = (job->count + cJSON_LINES_BATCH - 1) / cJSON_LINES_BATCH;
+
+	if (threads <= 0)
+		threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+	if ((size_t)threads > batches) // 多出的线程领不到记录
+		threads = (int)batches;
+	pthread_mutex_init(&job->lock, 0);
+	if (threads > 1 && (tid = (pthread_t *)cJSON_malloc((threads - 1) * sizeof(pthread_t))))
+		while (started < threads - 1 && !pthread_create(&tid[started], 0, lines_worker, job)) // 创建失败时用已有的线程继续
+			started++;
+	lines_worker(job); // 调用线程也参与解析
+	for (i = 0; i < started; i++)
+		pthread_join(tid[i], 0);
+	if (tid)
+		cJSON_free(tid);
+	pthread_mutex_destroy(&job->lock);
+#else
+	(void)threads;
+	lines_worker(job);
+#endif
+	cJSON_free(job->records);
+	return !job->stop;
+}
+
+int cJSON_ParseLinesEach(const char *value, size_t length, int threads, cJSON_LineFn fn, void *ctx)
+{
+	lines_job job;
+	memset(&job, 0, sizeof(job));
+	if (!value || !fn || !lines_split(&job, value, length))
+		return 0;
+	job.fn = fn, job.ctx = ctx;
+	return lines_run(&job, threads);
+}
+
+/* cJSON_ParseLines的回调：结果按序号放进数组，各线程写的槽位互不相同 */
+static int lines_store(void *ctx, size_t index, cJSON *item, const cJSON_Error *error)
+{
+	(void)error;
+	((cJSON **)ctx)[index] = item;
+	return 1;
+}
+
+cJSON **cJSON_ParseLines(const char *value, size_t length, int threads, size_t *count)
+{
+	lines_job job;
+	cJSON **items;
+	memset(&job, 0, sizeof(job));
+	*count = 0;
+	if (!value || !lines_split(&job, value, length))
+		return 0;
+	if (!(items = (cJSON **)cJSON_malloc((job.count ? job.count : 1) * sizeof(cJSON *))))
+	{
+		cJSON_free(job.records);
+		return 0;
+	}
+	job.fn = lines_store, job.ctx = items;
+	*count = job.count;
+	lines_run(&job, threads);
+	return items;
+}
+
+void cJSON_DeleteLines(cJSON **items, size_t count)
+{
+	size_t i;
+	if (!items)
+		return;
+	for (i = 0; i < count; i++)
+		cJSON_Delete(items[i]);
+	cJSON_free(items);
+}
+
+/* 预先分配缓冲区的方式渲染cJSON数据项，放不下时缓冲区按2的幂扩大，有realloc时尽量原地扩大，最后收缩到正好放下 */
+static char *print_buffered(cJSON *item, size_t prebuffer, int fmt, const cJSON_Allocator *alloc)
 {
 	printbuffer p;								// 创建缓冲区
-	p.buffer = (char *)cJSON_malloc(prebuffer); // 为缓冲区字符串分配内存
+	char *out;
+	p.buffer = (char *)mem_malloc(alloc, prebuffer); // 为缓冲区字符串分配内存
 	p.length = prebuffer;						// 设置缓冲区长度
 	p.offset = 0;								// 初始化缓冲区偏移量
-	return print_value(item, 0, fmt, &p);		// 调用print_value函数返回渲染后的文本
-												// 这里这个return不知道是干嘛用的，应该是写错了吧
+	p.write = 0, p.ctx = 0, p.fixed = 0;		// 输出全部留在缓冲区中
+	p.alloc = alloc;
+	if (!p.buffer)
+		return 0;
+	if (!print_value(item, fmt, &p)) // 失败时缓冲区可能已被ensure释放
+	{
+		if (p.buffer)
+			mem_free(alloc, p.buffer);
+		return 0;
+	}
+	if (mem_can_realloc(alloc) && p.length - p.offset > 4096 && (out = (char *)cJSON_grow(alloc, p.buffer, p.offset + 1, p.offset + 1))) // 多出一页以上时把多余的部分还给分配器
+		p.buffer = out;
+	return p.buffer;
+}
+
+/*
+	有realloc时直接从小缓冲区渲染，扩容多半原地完成，比先遍历一遍估计长度更快。
+	只有malloc和free时每次扩容都要复制，才先估计渲染后的长度，按估计一次分配缓冲区后渲染，通常不用再扩容
+*/
+static char *print_alloc(cJSON *item, int fmt, const cJSON_Allocator *alloc)
+{
+	size_t size;
+	if (!item)
+		return 0;
+	if (mem_can_realloc(alloc))
+		return print_buffered(item, 256, fmt, alloc);
+	size = print_length(item, fmt, 0, alloc);
+	size += size / 16 + 33; // 估计没有算转义，留一些余量；另加结尾的'\0'和print_number一次预留的32字节
+	return print_buffered(item, (size > 33) ? size : 256, fmt, alloc); // 估计失败时从小缓冲区开始按需扩容
+}
+
+/* 将一个cJSON数据项（实体或结构）按格式渲染成文本形式。 */
+char *cJSON_Print(cJSON *item) { return print_alloc(item, 1, 0); }
+/* 将一个cJSON数据项（实体或结构）不格式化渲染成文本形式。 */
+char *cJSON_PrintUnformatted(cJSON *item) { return print_alloc(item, 0, 0); } // fmt参数为0代表不格式化
+char *cJSON_PrintBuffered(cJSON *item, int prebuffer, int fmt) { return (prebuffer < 0) ? 0 : print_buffered(item, (size_t)prebuffer, fmt, 0); }
+/* 渲染结果从alloc分配，用同一个分配器的free_fn释放 */
+char *cJSON_PrintWithAllocator(cJSON *item, int fmt, const cJSON_Allocator *alloc) { return print_alloc(item, fmt, alloc); }
+
+/* 精确计算渲染后的长度，不含结尾的'\0' */
+size_t cJSON_PrintedLength(cJSON *item, int fmt) { return item ? print_length(item, fmt, 1, 0) : 0; }
+
+/* 渲染到调用者提供的length字节的缓冲区里，不分配内存；放不下时失败，缓冲区里是不完整的文本 */
+int cJSON_PrintPreallocated(cJSON *item, char *buffer, size_t length, int fmt)
+{
+	printbuffer p;
+	if (!buffer || !length)
+		return 0;
+	p.buffer = buffer, p.length = length, p.offset = 0;
+	p.write = 0, p.ctx = 0, p.fixed = 1, p.alloc = 0;
+	return print_value(item, fmt, &p);
+}
+
+/* 流式渲染：输出在chunk_size字节的缓冲区中攒满就交给write，缓冲区只有单个值（如很长的字符串）放不下时才扩容 */
+int cJSON_PrintStream(cJSON *item, int chunk_size, int fmt, cJSON_WriteFn write, void *ctx)
+{
+	printbuffer p;
+	int ok;
+
+	if (!write)
+		return 0;
+	p.length = (chunk_size > 0) ? (size_t)chunk_size : cJSON_STREAM_CHUNK;
+	p.buffer = (char *)cJSON_malloc(p.length);
+	p.offset = 0, p.write = write, p.ctx = ctx, p.fixed = 0, p.alloc = 0;
+	if (!p.buffer)
+		return 0;
+	ok = print_value(item, fmt, &p) && p.buffer; // 内层失败会释放缓冲区
+	if (ok)
+		ok = !p.offset || write(ctx, p.buffer, p.offset);
+	if (p.buffer)
+		cJSON_free(p.buffer);
+	return ok;
+}
+
+static int write_file(void *ctx, const char *buf, size_t len) { return fwrite(buf, 1, len, (FILE *)ctx) == len; }
+
+int cJSON_PrintToFile(cJSON *item, int fmt, FILE *fp) { return cJSON_PrintStream(item, 0, fmt, write_file, fp); }
+
+/* 写到文件描述符，处理部分写入和被信号打断的情况 */
+static int write_fd(void *ctx, const char *buf, size_t len)
+{
+	int fd = *(int *)ctx;
+	while (len)
+	{
+#ifdef _WIN32
+		int n = _write(fd, buf, (unsigned)len);
+#else
+		ssize_t n = write(fd, buf, len);
+#endif
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return 0;
+		buf += n, len -= (size_t)n;
+	}
+	return 1;
 }
 
+int cJSON_PrintToFd(cJSON *item, int fmt, int fd) { return cJSON_PrintStream(item, 0, fmt, write_fd, &fd); }
+
 /* 解析器核心 - 当遇到文本时，适当处理。 */
-static const char *parse_value(cJSON *item, const char *value)
+static const char *parse_value(cJSON *item, const char *value, parse_state *ps)
 {
 	if (!value)
 		return 0; /* 空值失败 */
-				  // strncmp 函数用于比较两个字符串的前 n 个字符，不考虑终止的空字符。
-	if (!strncmp(value, "null", 4))
+	if (value == ps->end)
+		return parse_fail(ps, value, cJSON_ErrorValue); /* 输入已经结束 */
+	// 关键字先确认剩余长度足够，再比较内容
+	if (ps->end - value >= 4 && !memcmp(value, "null", 4))
 	{
 		item->type = cJSON_NULL;
 		return value + 4; // 更新解析结束位置
 	}
-	if (!strncmp(value, "false", 5))
+	if (ps->end - value >= 5 && !memcmp(value, "false", 5))
 	{
 		item->type = cJSON_False;
 		return value + 5;
 	}
-	if (!strncmp(value, "true", 4))
+	if (ps->end - value >= 4 && !memcmp(value, "true", 4))
 	{
 		item->type = cJSON_True;
 		item->valueint = 1; // 赋值
 		return value + 4;
 	}
-	if (*value == '\"') // " 开头表字符串，调用parse_string函数
+	if (*value == '\"') // " 开头表字符串，调用parse_string函数（双阶段解析按索引中的两个引号解析）
 	{
-		return parse_string(item, value);
+		return ps->tape ? tape_string(item, value, ps) : parse_string(item, value, ps);
 	}
 	if (*value == '-' || (*value >= '0' && *value <= '9')) // 如果是数字或负号，解析为数字
 	{
-		return parse_number(item, value);
+		return parse_number(item, value, ps);
 	}
-	if (*value == '[') // 如果是左中括号，解析为数组
+	if (ps->lazy && (*value == '[' || *value == '{')) // 懒解析只记下容器的范围
+		return parse_lazy(item, value, ps);
+	if (*value == '[' || *value == '{') // 左中括号是数组，左大括号是对象，连同嵌套的容器一起解析
 	{
-		return parse_array(item, value);
+		return parse_container(item, value, ps);
 	}
-	if (*value == '{') // 如果是左大括号，解析为对象
+
+	return parse_fail(ps, value, cJSON_ErrorValue); /* 失败，记下解析失败的字符位置 */
+}
+
+/*
+	解析value处的数组或对象。嵌套的容器不递归解析，而是压入显式栈，在同一个循环里继续解析它的成员，
+	所以再深的输入也只占固定的调用栈；超过cJSON_NESTING_LIMIT层时失败。
+	每轮循环解析一个值item：容器写下左括号后入栈，标量整个解析完；然后在last（所在容器的最后一个成员）之后
+	处理逗号和右括号，闭合的容器出栈后就是上一层的最后一个成员。懒解析只展开最外层，里面的容器只记下范围。
+	双阶段解析（ps->tape）时每个结构字符都要与索引核对，对不上时直接失败。
+*/
+static const char *parse_container(cJSON *item, const char *value, parse_state *ps)
+{
+	walk_stack stack;
+	cJSON *parent, *last;
+	const char *next;
+	int n = 0; // parent已有的成员数，自动建向量用
+	stack_init(&stack, ps->alloc);
+	for (;;)
 	{
-		return parse_object(item, value);
+		if ((parse_at(ps, value, '[') || parse_at(ps, value, '{')) && (!stack.depth || !ps->lazy))
+		{
+			if (stack.depth == cJSON_NESTING_LIMIT)
+				return stack_done(&stack, parse_fail(ps, value, cJSON_ErrorDepth));
+			if (ps->tape && !tape_at(ps, value))
+				return stack_done(&stack, 0);
+			if (!stack_push(&stack, item))
+				return stack_done(&stack, parse_fail(ps, 0, cJSON_ErrorMemory));
+			item->type = (*value == '[') ? cJSON_Array : cJSON_Object;
+			if (ps->alloc && !item->internal && !internal_new(item, ps->alloc)) // 之后往这个容器里增删成员都用同一个分配器
+				return stack_done(&stack, parse_fail(ps, 0, cJSON_ErrorMemory));
+			parse_mark(ps, item);
+			parent = item, last = 0, n = 0;
+			value = skip(value + 1, ps->end); // 跳过左括号和一些空白字符
+		}
+		else
+		{
+			next = parse_value(item, value, ps);
+			parse_mark(ps, item); // parse_value会改写type，成功与否都在它之后标记，就地解析的键名不能被释放
+			if (!next)
+				return stack_done(&stack, 0);
+			parent = stack.items[stack.depth - 1], last = item;
+			value = skip(next, ps->end);
+		}
+
+		/* 逗号之后接着解析下一个成员，右括号闭合容器（空容器在左括号之后就遇到右括号） */
+		for (;;)
+		{
+			if (last && parse_at(ps, value, ','))
+			{
+				if (ps->tape && !tape_at(ps, value))
+					return stack_done(&stack, 0);
+				value = skip(value + 1, ps->end);
+				break;
+			}
+			if (!parse_at(ps, value, close_of(parent)))
+			{
+				if (!last)
+					break; // 非空容器的第一个成员
+				return stack_done(&stack, parse_fail(ps, value, ((parent->type & 255) == cJSON_Array) ? cJSON_ErrorArrayEnd : cJSON_ErrorObjectEnd)); /* 格式不正确 */
+			}
+			if (ps->tape && !tape_at(ps, value))
+				return stack_done(&stack, 0);
+			if (last)
+				parent->child->prev = last; // 首元素的prev指向尾元素，追加时不用遍历
+			if (!--stack.depth)
+				return stack_done(&stack, value + 1); /* 跳过右括号，返回解析结束位置 */
+			last = parent, parent = stack.items[stack.depth - 1], n = vector_count(parent);
+			value = skip(value + 1, ps->end);
+		}
+
+		/* 在parent末尾新建成员，对象成员先解析键名和冒号 */
+		if (!(item = parse_new_item(ps)))
+			return stack_done(&stack, 0); /* 内存分配失败 */
+		if (last)
+			last->next = item, item->prev = last; // 成员之间用next链接
+		else
+			parent->child = item;
+		vector_track(parent, item, ++n);
+		if ((parent->type & 255) == cJSON_Object)
+		{
+			if (!(next = ps->tape ? tape_string(item, value, ps) : parse_string(item, value, ps)))
+				return stack_done(&stack, 0);
+			item->string = item->valuestring; // 把解析到的字符串作为键名
+			item->valuestring = 0;
+			value = skip(next, ps->end);
+			if (!parse_at(ps, value, ':') || (ps->tape && !tape_at(ps, value)))
+			{
+				parse_mark(ps, item);												  // 失败时也要标记，就地解析的键名不能被释放
+				return stack_done(&stack, parse_fail(ps, value, cJSON_ErrorColon)); /* 键名后面没有冒号 */
+			}
+			value = skip(value + 1, ps->end);
+		}
 	}
+}
 
-	ep = value; // 指向解析失败的字符位置
-	return 0;	/* 失败 */
+/* 在缓冲区末尾追加len个字节，保持'\0'结尾 */
+static int print_append(printbuffer *p, const char *str, int len)
+{
+	char *out = ensure(p, len + 1);
+	if (!out)
+		return 0;
+	memcpy(out, str, len);
+	out[len] = 0;
+	p->offset += len;
+	return 1;
 }
 
-/* 将值渲染成字符串。*/
-static char *print_value(cJSON *item, int depth, int fmt, printbuffer *p)
+/* 追加n个制表符的缩进 */
+static int print_indent(printbuffer *p, int n)
 {
-	char *out = 0; // 用于存储渲染后的字符串
-	if (!item)	   // 错误的cJSON对象
+	char *out = ensure(p, n + 1);
+	if (!out)
 		return 0;
-	if (p) // 缓冲区非空
+	memset(out, '\t', n);
+	out[n] = 0;
+	p->offset += n;
+	return 1;
+}
+
+/* 渲染对象成员的开头：缩进、键名和冒号 */
+static int print_key(cJSON *item, int depth, int fmt, printbuffer *p)
+{
+	if ((fmt && !print_indent(p, depth)) || !print_string_ptr(item->string, p))
+		return 0;
+	return print_append(p, ":\t", fmt ? 2 : 1); // 格式化时冒号后面加一个制表符
+}
+
+/*
+	计算item渲染后的长度，不含结尾的'\0'，失败（print_value也会失败的情况）返回0。遍历方式与print_value相同。
+	exact为1时与print_value的输出逐字节一致：字符串按转义后计，数字先写到栈上再计，未展开的容器先展开。
+	为0时是cJSON_Print分配缓冲区前的估计，更快但不精确：字符串不算转义，非整数的数字按最长的24个字符计，
+	未展开的容器按原文的长度计，通常略大于实际长度。失败时清空栈并把n置0，回到上一层的循环随即结束。
+*/
+static size_t print_length(cJSON *item, int fmt, int exact, const cJSON_Allocator *alloc)
+{
+	walk_stack stack;
+	cJSON *parent;
+	size_t n = 0;
+	unsigned long long v;
+	char tmp[32];
+	int k, obj = 0; // obj：所在的容器是对象
+	stack_init(&stack, alloc);
+	for (;;)
 	{
-		switch ((item->type) & 255) // type取低八位，提高效率
-		{
-		case cJSON_NULL: // null类型
+		if (obj) // 缩进、键名和冒号
+			n += (exact ? string_length(item->string) : item->string ? strlen(item->string) : 0) + (fmt ? stack.depth + 4 : 3);
+		switch (item->type & 255)
 		{
-			out = ensure(p, 5);
-			if (out)
-				strcpy(out, "null"); // 将字符串"null"复制到缓冲区中
+		case cJSON_NULL:
+		case cJSON_True:
+			n += 4;
 			break;
-		} // 下同
 		case cJSON_False:
-		{
-			out = ensure(p, 6);
-			if (out)
-				strcpy(out, "false");
+			n += 5;
 			break;
-		}
-		case cJSON_True:
-		{
-			out = ensure(p, 5);
-			if (out)
-				strcpy(out, "true");
-			break;
-		}
-		case cJSON_Number: // 数字类型
-			out = print_number(item, p);
+		case cJSON_Number:
+			if (exact)
+				n += number_text(item, tmp);
+			else if (number_is_int64(item)) // 整数的位数
+			{
+				v = (item->valueint64 < 0) ? (n++, 0ull - (unsigned long long)item->valueint64) : (unsigned long long)item->valueint64;
+				for (k = 1; k < 20 && v >= cJSON_pow10_u64[k]; k++)
+					;
+				n += k;
+			}
+			else
+				n += 24;
 			break;
-		case cJSON_String: // 字符串类型
-			out = print_string(item, p);
+		case cJSON_String:
+			n += (exact ? string_length(item->valuestring) : item->valuestring ? strlen(item->valuestring) : 0) + 2;
 			break;
-		case cJSON_Array: // 数组类型
-			out = print_array(item, depth, fmt, p);
+		case cJSON_Array:
+		case cJSON_Object:
+			if (exact && !lazy_expand(item))
+				stack.depth = 0, n = 0;
+			else if (item->type & cJSON_Lazy)
+				n += item->internal->spanlen;
+			else if (!item->child) // 格式化的空对象在两个括号之间换行并缩进
+				n += ((item->type & 255) == cJSON_Array || !fmt) ? 2 : 3 + (stack.depth ? stack.depth - 1 : 0);
+			else
+			{
+				if (stack.depth == cJSON_NESTING_LIMIT || !stack_push(&stack, item))
+				{
+					stack.depth = 0, n = 0;
+					break;
+				}
+				n += ((item->type & 255) == cJSON_Array || !fmt) ? 1 : 2; // 左括号，格式化的对象还有换行
+				obj = (item->type & 255) == cJSON_Object;
+				item = item->child;
+				continue;
+			}
 			break;
-		case cJSON_Object: // 对象类型
-			out = print_object(item, depth, fmt, p);
+		default: // 未知的类型
+			stack.depth = 0, n = 0;
 			break;
 		}
+		while (stack.depth && !item->next) // 右括号，格式化的对象前面还有换行和缩进，然后回到上一层
+		{
+			parent = stack.items[stack.depth - 1];
+			n += ((parent->type & 255) == cJSON_Array || !fmt) ? 1 : stack.depth + 1;
+			item = stack.items[--stack.depth];
+			obj = stack.depth && (stack.items[stack.depth - 1]->type & 255) == cJSON_Object;
+		}
+		if (!stack.depth)
+			break;
+		n += fmt ? 2 : 1; // 逗号，格式化时后面还有空格或换行
+		item = item->next;
 	}
-	else // 缓冲区为空
+	stack_free(&stack);
+	return n;
+}
+
+/*
+	把item渲染进缓冲区p，offset随之前进。嵌套的容器不递归渲染，而是压入显式栈，在同一个循环里渲染它的成员，
+	所以调用栈的用量与嵌套深度无关；超过cJSON_NESTING_LIMIT层时失败，引用形成的环也因此不会无限展开。
+	每轮循环渲染一个值item：非空的容器写下左括号后入栈，接着渲染第一个成员，其余的整个渲染完；
+	然后有下一个兄弟就写逗号接着渲染它，没有就闭合所在的容器，出栈后回到上一层。
+	格式化时对象的成员缩进到所在的层数，数组的元素不换行，只在逗号后加一个空格。
+*/
+static int print_value(cJSON *item, int fmt, printbuffer *p)
+{
+	walk_stack stack;
+	cJSON *parent;
+	int ok;
+	stack_init(&stack, p->alloc);
+	for (;;)
 	{
-		switch ((item->type) & 255)
+		if (!item || !lazy_expand(item)) // 错误的cJSON对象，或者未展开的部分有语法错误
+		{
+			ok = 0;
+			break;
+		}
+		switch ((item->type) & 255) // type取低八位，提高效率
 		{
-		case cJSON_NULL: // 空值类型
-			out = cJSON_strdup("null");
+		case cJSON_NULL:
+			ok = print_append(p, "null", 4);
 			break;
-		case cJSON_False: // false类型
-			out = cJSON_strdup("false");
+		case cJSON_False:
+			ok = print_append(p, "false", 5);
 			break;
-		case cJSON_True: // true类型
-			out = cJSON_strdup("true");
+		case cJSON_True:
+			ok = print_append(p, "true", 4);
 			break;
-		case cJSON_Number:				 // 数字类型
-			out = print_number(item, 0); // 这里没有缓冲区，所以缓冲区指针参数传空指针。下同。
+		case cJSON_Number:
+			ok = print_number(item, p) != 0;
 			break;
-		case cJSON_String: // 字符串类型
-			out = print_string(item, 0);
+		case cJSON_String:
+			ok = print_string(item, p) != 0;
 			break;
-		case cJSON_Array: // 数组类型
-			out = print_array(item, depth, fmt, 0);
+		case cJSON_Array:
+		case cJSON_Object:
+			if (!item->child) // 空容器，格式化的空对象在两个括号之间换行
+			{
+				if ((item->type & 255) == cJSON_Array)
+					ok = print_append(p, "[]", 2);
+				else
+					ok = print_append(p, "{\n", fmt ? 2 : 1) && (!fmt || !stack.depth || print_indent(p, stack.depth - 1)) && print_append(p, "}", 1);
+				break;
+			}
+			if (stack.depth == cJSON_NESTING_LIMIT || !stack_push(&stack, item))
+			{
+				ok = 0;
+				break;
+			}
+			if ((item->type & 255) == cJSON_Array)
+				ok = print_append(p, "[", 1);
+			else
+				ok = print_append(p, "{\n", fmt ? 2 : 1) && print_key(item->child, stack.depth, fmt, p);
+			item = item->child;
+			continue;
+		default: // 未知的类型
+			ok = 0;
 			break;
-		case cJSON_Object: // 对象类型
-			out = print_object(item, depth, fmt, 0);
+		}
+		if (!ok)
 			break;
+
+		/* item渲染完了：有下一个兄弟就写逗号，没有就闭合所在的容器 */
+		while (ok && stack.depth)
+		{
+			parent = stack.items[stack.depth - 1];
+			if (item->next)
+			{
+				item = item->next;
+				if ((parent->type & 255) == cJSON_Array)
+					ok = print_append(p, ", ", fmt ? 2 : 1);
+				else
+					ok = print_append(p, ",\n", fmt ? 2 : 1) && print_key(item, stack.depth, fmt, p);
+				break;
+			}
+			if ((parent->type & 255) == cJSON_Array)
+				ok = print_append(p, "]", 1);
+			else
+				ok = (!fmt || (print_append(p, "\n", 1) && print_indent(p, stack.depth - 1))) && print_append(p, "}", 1);
+			stack.depth--;
+			item = parent;
 		}
+		if (!ok || !stack.depth)
+			break;
 	}
-	return out; // 返回渲染后的字符串指针
+	stack_free(&stack);
+	return ok;
 }
 
-/* 根据输入文本构建一个数组 */
-static const char *parse_array(cJSON *item, const char *value)
+/* cJSON_BuildIndex递归时，成员数达到该值的容器才建索引 */
+#define cJSON_INDEX_THRESHOLD 8
+/* 解析、复制和追加得到的数组，成员数达到该值时自动建向量，按下标遍历不再是平方复杂度。编译时用 -DcJSON_VECTOR_THRESHOLD=n 修改，0表示不自动建 */
+#ifndef cJSON_VECTOR_THRESHOLD
+#define cJSON_VECTOR_THRESHOLD 32
+#endif
+
+/* 取容器的记录，没有就新建一个空的（没有记录的容器用的是全局分配器）；引用节点不建索引，被引用的容器变化时无从同步 */
+static struct cJSON_Internal *index_get(cJSON *item)
 {
-	cJSON *child;
-	if (*value != '[')
-	{
-		ep = value;
+	if (item->internal)
+		return item->internal;
+	if (item->type & (cJSON_IsReference | cJSON_Lazy) || !cJSON_CONTAINER(item))
+		return 0;
+	return internal_new(item, 0);
+}
+
+/* 丢弃成员指针向量 */
+static void vector_drop(struct cJSON_Internal *index)
+{
+	mem_free(index->alloc, index->items);
+	index->items = 0;
+	index->length = index->capacity = 0;
+}
+
+/* 为容器建立成员指针向量，n是已知的成员数 */
+static struct cJSON_Internal *vector_build(cJSON *array, int n)
+{
+	struct cJSON_Internal *index = index_get(array);
+	cJSON *c;
+	int i = 0;
+
+	if (!index)
 		return 0;
-	} /* 不是数组 */
+	index->items = (cJSON **)mem_malloc(index->alloc, (n ? n : 1) * sizeof(cJSON *));
+	if (!index->items)
+		return 0;
+	for (c = array->child; c; c = c->next)
+		index->items[i++] = c;
+	index->length = index->capacity = n;
+	return index;
+}
 
-	item->type = cJSON_Array; // 设置当前项的类型为数组
-	value = skip(value + 1);  // 跳过左括号和一些空白字符
-	if (*value == ']')		  // 数组结束标志
-		return value + 1;	  /* 空数组直接返回 */
+/* 成员插入已建向量的容器第which个位置，which等于length时为追加 */
+static void vector_insert(cJSON *array, int which, cJSON *item)
+{
+	struct cJSON_Internal *index = cJSON_INDEX(array);
+	cJSON **items;
+	int capacity;
 
-	item->child = child = cJSON_New_Item(); // 为child分配空间，并将item的子指针指向child
-	if (!item->child)
-		return 0;								   /* 内存分配失败 */
-	value = skip(parse_value(child, skip(value))); /* 跳过空白字符，将数组中解析的值赋给child后返回下一位置 */
-	if (!value)
-		return 0; // 空指针，解析失败
-
-	// 匹配到逗号，说明还有元素，继续解析数组中其他元素，以链表的方式插入元素
-	while (*value == ',')
-	{
-		cJSON *new_item;
-		if (!(new_item = cJSON_New_Item()))
-			return 0;									   /* 为新元素分配空间失败 */
-		child->next = new_item;							   // 数组间成员用next链接，区别于上面的child
-		new_item->prev = child;							   // 将新元素插入数组
-		child = new_item;								   // 更新child指针
-		value = skip(parse_value(child, skip(value + 1))); // 为新元素赋值
-		if (!value)
-			return 0; /* 同上解析失败 */
-	}
-
-	if (*value == ']')	  // 匹配到右括号，说明数组解析结束
-		return value + 1; /* 跳过右括号，更新解析结束位置并返回 */
-	ep = value;
-	return 0; /* 非正常的情况，一般是数组的格式不正确 */
-}
-
-/* 将数组选染成文本 */
-static char *print_array(cJSON *item, int depth, int fmt, printbuffer *p)
-{
-	char **entries;						 // 用于存储每个数组元素的字符串数组
-	char *out = 0, *ptr, *ret;			 // out 用于存储输出字符串,ret用于暂存解析的数组元素，ptr用于遍历赋值
-	int len = 5;						 // 用于记录输出字符串长度，这里5应该是故意放了个比较大，足以容纳数组元素长度的数字，一般包括左右括号加一个结束标记3就够了
-	cJSON *child = item->child;			 // 指向数组的第一个元素
-	int numentries = 0, i = 0, fail = 0; // numentries记录数组条目数量，i用来暂存缓存区的偏移量，fail用来标记是否解析失败
-	size_t tmplen = 0;					 // 用于记录字符串数组元素的长度
-
-	/* 数组中有几个条目 */
-	while (child) // 遍历数组
-		numentries++, child = child->next;
-	/* 显式处理空数组 */
-	if (!numentries)
-	{
-		if (p)
-			out = ensure(p, 3); // 3=左右中括号加一个结束标记
-		else
-			out = (char *)cJSON_malloc(3);
-		if (out)
-			strcpy(out, "[]");
-		return out;
-	}
-	// 如果用printbuffer输出
-	if (p)
-	{
-		/* 组成输出数组 */
-		i = p->offset;
-		ptr = ensure(p, 1);
-		if (!ptr)
-			return 0;
-		*ptr = '[';			   // 左中括号赋值
-		p->offset++;		   // 更新缓存区偏移量
-		child = item->child;   // 指针复位
-		while (child && !fail) // 无失败的情况下遍历数组
-		{
-			print_value(child, depth + 1, fmt, p); // 递归调用解析数组元素，这里其实已经将解析好的元素存入缓冲区了
-			p->offset = update(p);				   // 更新缓存区偏移量
-			if (child->next)					   // 还有下一个元素，打印逗号
-			{
-				len = fmt ? 2 : 1; // 跟据是否格式化为len赋值
-				ptr = ensure(p, len + 1);
-				if (!ptr)
-					return 0;
-				*ptr++ = ','; // 逗号
-				if (fmt)	  // 格式化输出需要加一个空格
-					*ptr++ = ' ';
-				*ptr = 0;		  // 结束标记
-				p->offset += len; // 更新缓存区偏移量
-			}
-			child = child->next; // 指向数组下一个元素
-		}
-		ptr = ensure(p, 2); // 再分配两个字节
-		if (!ptr)
-			return 0;
-		*ptr++ = ']';		   // 右中括号
-		*ptr = 0;			   // 结束标记
-		out = (p->buffer) + i; // 返回数组起始位置
-	}
-	else
+	if (!index || !index->items)
+		return;
+	if (index->length == index->capacity) // 容量翻倍
 	{
-		/* 分配一个字符串数组 */
-		entries = (char **)cJSON_malloc(numentries * sizeof(char *));
-		if (!entries)
-			return 0;									 // 内存分配失败
-		memset(entries, 0, numentries * sizeof(char *)); // 字符串数组初始化
-		/* 检索所有结果并存入字符串数组 */
-		child = item->child;   // 复位指向数组的第一个元素
-		while (child && !fail) // 无失败的情况下遍历数组
+		capacity = index->capacity ? index->capacity * 2 : 8;
+		items = (cJSON **)cJSON_grow(index->alloc, index->items, index->length * sizeof(cJSON *), capacity * sizeof(cJSON *));
+		if (!items)
 		{
-			ret = print_value(child, depth + 1, fmt, 0); // 递归调用解析数组元素
-			entries[i++] = ret;							 // 为字符串数组赋值
-			if (ret)									 // 解析成功，计算长度
-				len += strlen(ret) + 2 + (fmt ? 1 : 0);	 // 这里我觉得+1就行了，和上面通过缓冲区分配保持一致，应该不影响结果只是多分配了空间。但是这里每一个元素都多分配了一个元素，一旦数组较大，内存浪费会很严重。
-			else										 // 解析失败为fail赋值
-				fail = 1;
-			child = child->next;
+			vector_drop(index); // 扩容失败就丢弃向量，下次按下标访问时重建
+			return;
 		}
+		index->items = items;
+		index->capacity = capacity;
+	}
+	memmove(index->items + which + 1, index->items + which, (index->length - which) * sizeof(cJSON *));
+	index->items[which] = item;
+	index->length++;
+}
 
-		/* 如果没有失败，尝试为输出字符串分配内存 */
-		if (!fail)
-			out = (char *)cJSON_malloc(len);
-		/* 分配失败，fail置1 */
-		if (!out)
-			fail = 1;
+/*
+	自动建向量：item刚接到array末尾，n是array现在的成员数。已有向量时追加；没有时，数组的成员数正好达到cJSON_VECTOR_THRESHOLD就用这些成员建向量。
+	解析和复制时边建边追加，刚建好的成员还在缓存里，不用等容器闭合后再走一遍长链表。向量只是加速，内存不足时不建，getter照样按链表走
+*/
+static void vector_track(cJSON *array, cJSON *item, int n)
+{
+	struct cJSON_Internal *index = array->internal;
+	if (index && index->items && index->length < index->capacity) // 大多数追加不用扩容
+		index->items[index->length++] = item;
+	else if (index && index->items)
+		vector_insert(array, index->length, item);
+	else if (n == cJSON_VECTOR_THRESHOLD && (array->type & (255 | cJSON_IsReference | cJSON_Lazy)) == cJSON_Array)
+		vector_build(array, n);
+}
 
-		/* 处理失败 */
-		if (fail)
-		{
-			/*
-				这里释放字符串指针必须要先释放各数组元素（也就是每个字符串），然后再释放字符串数组。
-				因为字符串数组个元素间（也就是各字符串）并不是连续的，而存储指向他们的指针是连续的。
-				如果直接调用 cJSON_free(entries)，只会释放指针数组本身，而每个字符串的内存依然没有被释放。
-			*/
-			for (i = 0; i < numentries; i++)
-				if (entries[i])
-					cJSON_free(entries[i]); // 释放每个字符串
-			cJSON_free(entries);			// 释放字符串数组
-			return 0;
-		}
+/* 还没有向量的数组已有的成员数，最多数到cJSON_VECTOR_THRESHOLD；回到上一层继续追加，或者不知道成员数时用 */
+static int vector_count(cJSON *array)
+{
+	cJSON *c = array->child;
+	int n = 0;
+	if ((array->internal && array->internal->items) || (array->type & 255) != cJSON_Array)
+		return 0;
+	for (; c && n < cJSON_VECTOR_THRESHOLD; c = c->next)
+		n++;
+	return n;
+}
 
-		/* 构造输出数组 */
-		*out = '[';	   // 左中括号
-		ptr = out + 1; // 利用临时指针ptr赋值，后面out依然指向字符串首地址
-		*ptr = 0;
-		for (i = 0; i < numentries; i++)
-		{
-			tmplen = strlen(entries[i]);	 // 记录每个字符串数组元素的长度
-			memcpy(ptr, entries[i], tmplen); // 将字符串数组元素复制到ptr
-			ptr += tmplen;					 // 更新ptr，跳过已复制元素的长度
-			if (i != numentries - 1)		 // 还有下一个元素，打印逗号
-			{
-				*ptr++ = ',';
-				if (fmt) // 如果需要格式化，则加一个空格
-					*ptr++ = ' ';
-				*ptr = 0;
-			}
-			cJSON_free(entries[i]); // 复制完就可以释放内存
-		}
-		cJSON_free(entries); // 释放字符串数组
-		*ptr++ = ']';		 // 右中括号
-		*ptr++ = 0;			 // 结束标记
+/* 从已建向量的容器中移除第which个成员，which为-1时按指针c查找位置 */
+static void vector_remove(cJSON *array, int which, cJSON *c)
+{
+	struct cJSON_Internal *index = cJSON_INDEX(array);
+	if (!index || !index->items)
+		return;
+	if (which < 0)
+		for (which = 0; which < index->length && index->items[which] != c; which++)
+			;
+	if (which >= index->length)
+		return;
+	memmove(index->items + which, index->items + which + 1, (index->length - which - 1) * sizeof(cJSON *));
+	index->length--;
+}
+
+/* 获取数组大小，建过向量时直接返回缓存的大小 */
+int cJSON_GetArraySize(cJSON *array)
+{
+	struct cJSON_Internal *index;
+	cJSON *c;
+	int i = 0;
+	if (!lazy_expand(array))
+		return 0;
+	index = cJSON_INDEX(array);
+	if (index && index->items)
+		return index->length;
+	for (c = array->child; c; c = c->next)
+		i++;
+	return i;
+}
+/* 获取数组第item个成员，建过向量时直接取，否则按链表走。和查找一样不修改树 */
+cJSON *cJSON_GetArrayItem(cJSON *array, int item)
+{
+	struct cJSON_Internal *index;
+	cJSON *c;
+
+	if (!lazy_expand(array))
+		return 0;
+	index = cJSON_INDEX(array);
+	if (index && index->items)
+	{
+		if (item < 0) // 与链表遍历一致，负下标取第一个成员
+			item = 0;
+		return item < index->length ? index->items[item] : 0; // 返回第item个成员的指针
 	}
-	return out;
+	c = array->child; // 指向第一个成员
+	while (c && item > 0)
+		item--, c = c->next;
+	return c;
+}
+
+/* 忽略大小写的FNV-1a哈希，大小写不同的键落在同一个位置，区分/不区分大小写的查找共用一张表 */
+static unsigned cJSON_hash(const char *str)
+{
+	unsigned h = 2166136261u;
+	for (; *str; ++str)
+		h = (h ^ (unsigned)tolower(*(const unsigned char *)str)) * 16777619u;
+	return h;
 }
 
-/* 根据文本构建对象 */
-static const char *parse_object(cJSON *item, const char *value)
+/* 把item放入哈希表，调用者保证还有空槽 */
+static void index_put(struct cJSON_Internal *index, cJSON *item, unsigned hash)
 {
-	cJSON *child;
-	if (*value != '{')
+	unsigned mask = index->size - 1, i = hash & mask;
+	while (index->slots[i].item) // 线性探测找空槽，顺便检查重复键
 	{
-		ep = value;
-		return 0;
-	} /* 不是对象 */
+		if (index->slots[i].hash == hash && !cJSON_strcasecmp(index->slots[i].item->string, item->string))
+			index->dup = 1;
+		i = (i + 1) & mask;
+	}
+	index->slots[i].hash = hash;
+	index->slots[i].item = item;
+	index->count++;
+}
 
-	item->type = cJSON_Object; // 设置当前项的类型为对象
-	value = skip(value + 1);   // 跳过左括号和一些空白字符
-	if (*value == '}')
-		return value + 1; /* 空对象直接返回 */
+/* 把哈希表扩容到size个槽并重新插入 */
+static int index_grow(struct cJSON_Internal *index, int size)
+{
+	cJSON_IndexSlot *old = index->slots;
+	int i, oldsize = index->size;
 
-	item->child = child = cJSON_New_Item(); // 为child分配空间，并将item的子指针指向child
-	if (!item->child)
-		return 0;									// 内存分配失败
-	value = skip(parse_string(child, skip(value))); // 跳过空白字符，将对象中解析的字符串赋给child后更新value指针
-	if (!value)
-		return 0;						// 未匹配右括号value就结束了，解析失败
-	child->string = child->valuestring; // 把解析到的字符串赋给第一个键名
-	child->valuestring = 0;				// 清空第一个键名所对应的值
-	if (*value != ':')
+	index->slots = (cJSON_IndexSlot *)mem_malloc(index->alloc, size * sizeof(cJSON_IndexSlot));
+	if (!index->slots)
 	{
-		ep = value;
+		index->slots = old;
 		return 0;
-	} /* 非对象的情况，键名后面没有冒号，解析失败 */
-	value = skip(parse_value(child, skip(value + 1))); /* 跳过冒号与空白字符，将冒号后解析的值赋给child后跳过空白字符，返回下一位置 */
-	if (!value)
-		return 0; // 未匹配右括号value就结束了，解析失败
-
-	while (*value == ',') // 匹配到逗号，继续解析对象中其他键值对，基本与上同
-	{
-		cJSON *new_item;
-		if (!(new_item = cJSON_New_Item()))					// 为new_item分配空间，用来存储下一个键值对
-			return 0;										/* 内存分配失败 */
-		child->next = new_item;								// 对象间成员用next链接，区别于上面的child
-		new_item->prev = child;								// 将新元素插入对象
-		child = new_item;									// 更新child指针
-		value = skip(parse_string(child, skip(value + 1))); // 跳过分隔逗号和空白字符，将键名赋给child后返回下一位置
-		if (!value)
-			return 0;
-		child->string = child->valuestring;
-		child->valuestring = 0;
-		if (*value != ':')
-		{
-			ep = value;
-			return 0;
-		} /* 失败! */
-		value = skip(parse_value(child, skip(value + 1))); /* 解析并赋键值 */
-		if (!value)
-			return 0;
 	}
+	memset(index->slots, 0, size * sizeof(cJSON_IndexSlot));
+	index->size = size;
+	index->count = 0;
+	for (i = 0; i < oldsize; i++)
+		if (old[i].item)
+			index_put(index, old[i].item, old[i].hash);
+	mem_free(index->alloc, old);
+	return 1;
+}
 
-	if (*value == '}')
-		return value + 1; /* 对象解析结束 */
-	ep = value;
-	return 0; /* 格式错误，更新错误指针 */
-}
-
-/* 把对象渲染成字符串 */
-static char *print_object(cJSON *item, int depth, int fmt, printbuffer *p)
-{
-	char **entries = 0, **names = 0; // 临时数组存储键名，值
-	char *out = 0, *ptr, *ret, *str;
-	int len = 7, i = 0, j;		  // len临时记录所需长度，默认长度足够的较大值7
-	cJSON *child = item->child;	  // 指向对象第一个成员
-	int numentries = 0, fail = 0; // 记录对象成员个数，失败标记
-	size_t tmplen = 0;
-	/* 对象成员计数 */
-	while (child)
-		numentries++, child = child->next;
-	/* 显式处理空对象的情况 */
-	if (!numentries) // 处理空对象
-	{
-		if (p)												 // 利用打印缓冲区
-			out = ensure(p, fmt ? depth + 4 : 3);			 // 根据是否格式化分配内存
-		else												 // 手动分配内存
-			out = (char *)cJSON_malloc(fmt ? depth + 4 : 3); // 非格式化左右大括号加结束标记，格式化多一个换行符加上每层多一个缩进符
-		if (!out)
-			return 0; // 分配失败
-		ptr = out;
-		*ptr++ = '{'; // 左大括号
-		if (fmt)	  // 格式化
-		{
-			*ptr++ = '\n';					// 换行
-			for (i = 0; i < depth - 1; i++) // 根据层数缩进，为了匹配左括号的位置
-				*ptr++ = '\t';
-		}
-		*ptr++ = '}'; // 右大括号
-		*ptr++ = 0;	  // 结束标记
-		return out;
-	}
-	if (p) // 利用打印缓冲区处理非空对象
-	{
-		i = p->offset;			  // 记录缓冲区偏移量
-		len = fmt ? 2 : 1;		  // 非格式化左大括号，格式化多一个换行符
-		ptr = ensure(p, len + 1); // ptr指向缓冲区，加上结束标记空间
-		if (!ptr)
-			return 0; // 分配失败
-		*ptr++ = '{'; // 左大括号
-		if (fmt)
-			*ptr++ = '\n';	 // 换行
-		*ptr = 0;			 // 结束标记
-		p->offset += len;	 // 更新缓冲区偏移量
-		child = item->child; // 指向对象第一个成员
-		depth++;			 // 层数加1
-		while (child)		 // 遍历当前层的成员
-		{
-			if (fmt) // 格式化处理
-			{
-				ptr = ensure(p, depth); // 确保缩进符空间
-				if (!ptr)
-					return 0;				// 分配失败
-				for (j = 0; j < depth; j++) // 根据层数缩进
-					*ptr++ = '\t';
-				p->offset += depth; // 更新缓冲区偏移量
-			}
-			print_string_ptr(child->string, p); // 渲染键名
-			p->offset = update(p);				// 更新缓冲区偏移量
+/* 丢弃键名哈希表 */
+static void hash_drop(struct cJSON_Internal *index)
+{
+	mem_free(index->alloc, index->slots);
+	index->slots = 0;
+	index->size = index->count = index->dup = 0;
+}
 
-			len = fmt ? 2 : 1; // 非格式化冒号，格式化多一个缩进符
-			ptr = ensure(p, len);
-			if (!ptr)
-				return 0;
-			*ptr++ = ':'; // 冒号
-			if (fmt)
-				*ptr++ = '\t'; // 缩进
-			p->offset += len;  // 更新缓冲区偏移量
+/* 为有n个成员的对象建立键名哈希表，内存不足时返回0 */
+static int hash_build(cJSON *object, int n)
+{
+	struct cJSON_Internal *index = index_get(object);
+	cJSON *c;
+	int size = 16;
 
-			print_value(child, depth, fmt, p); // 渲染键值
-			p->offset = update(p);			   // 更新缓冲区偏移量
+	if (!index)
+		return 0;
+	while (size < n * 2) // 装载因子不超过1/2
+		size <<= 1;
+	if (!index_grow(index, size))
+		return 0;
+	for (c = object->child; c; c = c->next)
+		if (c->string) // 没有键名的成员不入表，按键名查找也找不到它
+			index_put(index, c, cJSON_hash(c->string));
+	return 1;
+}
 
-			len = (fmt ? 1 : 0) + (child->next ? 1 : 0); // 有下一个成员加逗号，格式化多一个换行符
-			ptr = ensure(p, len + 1);					 // 确保缓存区空间
-			if (!ptr)
-				return 0;
-			if (child->next)
-				*ptr++ = ','; // 逗号
-			if (fmt)
-				*ptr++ = '\n';	 // 换行
-			*ptr = 0;			 // 结束标记
-			p->offset += len;	 // 更新缓冲区偏移量
-			child = child->next; // 指向下一个成员
-		}
-		ptr = ensure(p, fmt ? (depth + 1) : 2); // 非格式化右大括号加结束标记，格式化每层多一个缩进符
-		if (!ptr)
-			return 0;
-		if (fmt)
-			for (i = 0; i < depth - 1; i++)
-				*ptr++ = '\t'; // 根据层数缩进
-		*ptr++ = '}';		   // 右大括号
-		*ptr = 0;			   // 结束标记
-		out = (p->buffer) + i; // 返回起始地址
-	}
-	else // 手动分配内存处理非空对象
+/* 成员加入已建哈希表的对象 */
+static void hash_add(cJSON *object, cJSON *item)
+{
+	struct cJSON_Internal *index = cJSON_INDEX(object);
+	if (!index || !index->slots || !item->string)
+		return;
+	if ((index->count + 1) * 2 > index->size && !index_grow(index, index->size * 2))
 	{
-		entries = (char **)cJSON_malloc(numentries * sizeof(char *)); // 为键名字符串数组分配空间
-		if (!entries)
-			return 0;
-		names = (char **)cJSON_malloc(numentries * sizeof(char *)); // 为键值字符串数组分配空间
-		if (!names)
-		{
-			cJSON_free(entries); // 键值字符串数组分配失败，释放键名字符串数组
-			return 0;
-		}
-
-		// 初始化数组
-		memset(entries, 0, sizeof(char *) * numentries);
-		memset(names, 0, sizeof(char *) * numentries);
+		hash_drop(index); // 扩容失败就丢弃哈希表，下次查找时重建
+		return;
+	}
+	index_put(index, item, cJSON_hash(item->string));
+}
 
-		/* 将所有键值对存入数组 */
-		child = item->child; // 指向对象第一个成员
-		depth++;			 // 层数加1
-		if (fmt)
-			len += depth; // 格式化每层多一个缩进符
-		while (child)	  // 遍历赋值键值对
+/* 成员离开已建哈希表的对象，用后移法删除，不留墓碑 */
+static void hash_remove(cJSON *object, cJSON *item)
+{
+	struct cJSON_Internal *index = cJSON_INDEX(object);
+	unsigned mask, i, j, k;
+	if (!index || !index->slots || !item->string)
+		return;
+	mask = index->size - 1;
+	for (i = cJSON_hash(item->string) & mask; index->slots[i].item != item; i = (i + 1) & mask)
+		if (!index->slots[i].item) // 键名被改过，哈希对不上，无法定位就丢弃哈希表
 		{
-			names[i] = str = print_string_ptr(child->string, 0);
-			entries[i++] = ret = print_value(child, depth, fmt, 0); // 当键名和键值都已经存储完毕后，i++ 才执行
-			if (str && ret)
-				len += strlen(ret) + strlen(str) + 2 + (fmt ? 2 + depth : 0); // 键名和键值长度+冒号与逗号+行前缩进，冒号前缩进与换行符
-			else
-				fail = 1; // fail标记赋值失败
-			child = child->next;
+			hash_drop(index);
+			return;
 		}
-
-		/* 为输出字符串分配空间 */
-		if (!fail)
-			out = (char *)cJSON_malloc(len);
-		if (!out)
-			fail = 1;
-
-		/* 处理失败 */
-		if (fail)
+	for (;;)
+	{
+		index->slots[i].item = 0;
+		for (j = i;;)
 		{
-			for (i = 0; i < numentries; i++) // 释放字符串
+			j = (j + 1) & mask;
+			if (!index->slots[j].item)
 			{
-				if (names[i])
-					cJSON_free(names[i]);
-				if (entries[i])
-					cJSON_free(entries[i]);
+				index->count--;
+				return;
 			}
-			// 释放字符串数组
-			cJSON_free(names);
-			cJSON_free(entries);
-			return 0;
+			k = index->slots[j].hash & mask; // 该槽元素的理想位置
+			if ((i <= j) ? (i < k && k <= j) : (i < k || k <= j))
+				continue; // 理想位置在(i, j]之间，不能前移
+			break;
 		}
+		index->slots[i] = index->slots[j]; // 前移填补空槽
+		i = j;
+	}
+}
 
-		/* 构造输出字符串 */
-		*out = '{'; // 左大括号
-		ptr = out + 1;
-		if (fmt)
-			*ptr++ = '\n';				 // 换行
-		*ptr = 0;						 // 结束标记
-		for (i = 0; i < numentries; i++) // 键值对
-		{
-			if (fmt) // 对齐缩进
-				for (j = 0; j < depth; j++)
-					*ptr++ = '\t';
-			tmplen = strlen(names[i]);	   // 键名长度
-			memcpy(ptr, names[i], tmplen); // 拷贝键名
-			ptr += tmplen;				   // 指针后移
-			*ptr++ = ':';				   // 冒号
-			if (fmt)					   // 格式化缩进
-				*ptr++ = '\t';
-			strcpy(ptr, entries[i]);   // 拷贝键值
-			ptr += strlen(entries[i]); // 指针后移
-			if (i != numentries - 1)   // 不是最后一个键值对，添加逗号
-				*ptr++ = ',';
-			if (fmt) // 格式化换行
-				*ptr++ = '\n';
-			*ptr = 0; // 结束标记
-			// 释放键名与键值字符串
-			cJSON_free(names[i]);
-			cJSON_free(entries[i]);
-		}
+/* 只丢弃向量和哈希表，记录上的分配器和输入范围还要用 */
+void cJSON_ResetIndex(cJSON *item)
+{
+	if (!item || !item->internal)
+		return;
+	vector_drop(item->internal);
+	hash_drop(item->internal);
+}
 
-		// 释放键名与键值字符串数组
-		cJSON_free(names);
-		cJSON_free(entries);
+/* 按键名查找对象成员，建过哈希索引时查表，否则按链表找。查找不修改树，多个线程可以同时读同一棵树 */
+static cJSON *get_object_item(cJSON *object, const char *string, int case_sensitive)
+{
+	struct cJSON_Internal *index;
+	unsigned hash, mask, i;
+	cJSON *c;
 
-		if (fmt) // 对齐缩进
-			for (i = 0; i < depth - 1; i++)
-				*ptr++ = '\t';
-		*ptr++ = '}'; // 右大括号
-		*ptr++ = 0;	  // 结束标记
+	if (!lazy_expand(object))
+		return 0;
+	index = cJSON_INDEX(object);
+	if (index && index->slots && string && !index->dup)
+	{
+		hash = cJSON_hash(string);
+		mask = index->size - 1;
+		for (i = hash & mask; (c = index->slots[i].item); i = (i + 1) & mask)
+			if (index->slots[i].hash == hash && !(case_sensitive ? strcmp(c->string, string) : cJSON_strcasecmp(c->string, string)))
+				return c;
+		return 0;
 	}
-	return out;
+	c = object->child;
+	while (c && (case_sensitive ? (c->string && string ? strcmp(c->string, string) : c->string != string) : cJSON_strcasecmp(c->string, string)))
+		c = c->next;
+	return c;
 }
+cJSON *cJSON_GetObjectItem(cJSON *object, const char *string) { return get_object_item(object, string, 0); }
+cJSON *cJSON_GetObjectItemCaseSensitive(cJSON *object, const char *string) { return get_object_item(object, string, 1); }
 
-/* 获取数组大小 */
-int cJSON_GetArraySize(cJSON *array)
-{
-	cJSON *c = array->child;
-	int i = 0;
-	while (c)
-		i++, c = c->next;
-	return i;
-}
-/* 获取数组第item个成员 */
-cJSON *cJSON_GetArrayItem(cJSON *array, int item)
+/* 为一个容器建立成员指针向量，对象再建键名哈希表；force为0时成员少于cJSON_INDEX_THRESHOLD的容器不建。内存不足时返回0 */
+static int index_build(cJSON *item, int force)
 {
-	cJSON *c = array->child; // 指向第一个成员
-	while (c && item > 0)	 // 遍历
-		item--, c = c->next;
-	return c; // 返回第item个成员的指针
+	struct cJSON_Internal *index;
+	cJSON *c;
+	int n = 0;
+	if (!lazy_expand(item))
+		return 0;
+	if (((item->type & 255) != cJSON_Array && (item->type & 255) != cJSON_Object) || (item->type & cJSON_IsReference))
+		return 1;
+	for (c = item->child; c; c = c->next)
+		n++;
+	if (n < cJSON_INDEX_THRESHOLD && !force)
+		return 1;
+	index = cJSON_INDEX(item);
+	if ((!index || !index->items) && !(index = vector_build(item, n)))
+		return 0;
+	return (item->type & 255) != cJSON_Object || index->slots || hash_build(item, n);
 }
-cJSON *cJSON_GetObjectItem(cJSON *object, const char *string)
+
+/* 先序遍历，不递归：有子节点就把当前节点入栈进入子节点，没有兄弟就出栈回到上一层；引用节点不进入，遇到环也能结束 */
+int cJSON_BuildIndex(cJSON *item, int recurse)
 {
-	cJSON *c = object->child;
-	while (c && cJSON_strcasecmp(c->string, string))
+	walk_stack stack;
+	cJSON *c;
+	int ok;
+	if (!item)
+		return 0;
+	if (!(ok = index_build(item, 1)) || !recurse)
+		return ok;
+	stack_init(&stack, 0);
+	for (c = item;;)
+	{
+		if (c != item && !index_build(c, 0))
+			ok = 0;
+		if (c->child && !(c->type & cJSON_IsReference))
+		{
+			if (!stack_push(&stack, c))
+			{
+				ok = 0;
+				break;
+			}
+			c = c->child;
+			continue;
+		}
+		while (stack.depth && !c->next)
+			c = stack.items[--stack.depth];
+		if (!stack.depth)
+			break;
 		c = c->next;
-	return c;
+	}
+	stack_free(&stack);
+	return ok;
 }
 
 /* 链表尾插工具 */
@@ -1167,43 +3534,62 @@ static void suffix_object(cJSON *prev, cJSON *item)
 	item->prev = prev; // 将prev链接到item之前
 }
 /* Utility for handling references. */ // mark:5
-static cJSON *create_reference(cJSON *item)
+/* 引用节点要加进parent，从parent的分配器分配 */
+static cJSON *create_reference(cJSON *item, cJSON *parent)
 {
-	cJSON *ref = cJSON_New_Item();
+	cJSON *ref;
+	if (!lazy_expand(item)) // 引用与原节点共用成员，先展开，成员归原节点所有
+		return 0;
+	ref = cJSON_New_Item(cJSON_ALLOC(parent));
 	if (!ref)
 		return 0;
 	memcpy(ref, item, sizeof(cJSON));
 	ref->string = 0;
-	ref->type |= cJSON_IsReference;
+	ref->type = (ref->type | cJSON_IsReference) & ~(cJSON_StringIsConst | cJSON_InArena | cJSON_ArenaOwner); // 引用节点本身在堆上
 	ref->next = ref->prev = 0;
+	ref->internal = 0; // 引用上不建索引；成员归原节点所有，引用节点本身按parent的分配器释放
 	return ref;
 }
 
 /* 添加项到数组/对象 */
 void cJSON_AddItemToArray(cJSON *array, cJSON *item)
 {
-	cJSON *c = array->child; // 指向第一个成员
-	if (!item)				 // item为空则直接返回结束执行
+	cJSON *c;
+	if (!item) // item为空则直接返回结束执行
+		return;
+	if (!lazy_expand(array)) // 未展开的部分有语法错误或内存不足，加不进去：item已交给数组，释放掉，不让它泄漏
+	{
+		cJSON_DeleteWithAllocator(item, cJSON_ALLOC(array));
 		return;
+	}
+	c = array->child; // 指向第一个成员
 	if (!c) // 这是第一个成员
 	{
 		array->child = item; // 连入item
+		item->prev = item;	 // 唯一的成员既是首也是尾
+		item->next = 0;
 	}
 	else // 不是第一个成员
 	{
-		while (c && c->next) // 遍历到最后一个成员
-			c = c->next;
-		suffix_object(c, item); // 将item链接到c之后
+		c = c->prev;			  // 首元素的prev就是尾元素
+		if (!c)					  // 手工拼接的链表可能没有维护尾指针，退回遍历
+			for (c = array->child; c->next; c = c->next)
+				;
+		suffix_object(c, item);	  // 将item链接到c之后
+		array->child->prev = item; // 更新尾指针
 	}
+	hash_add(array, item); // 同步索引
+	vector_track(array, item, vector_count(array));
 }
-/* 通过改造已有cJSON类型的方式向对象内添加新项 */
+/* 通过改造已有cJSON类型的方式向对象内添加新项，键名的副本从object的分配器分配 */
 void cJSON_AddItemToObject(cJSON *object, const char *string, cJSON *item)
 {
 	if (!item)
 		return;		  // item为空则直接返回结束执行
-	if (item->string) // item的键名不为空，则释放item的string
-		cJSON_free(item->string);
-	item->string = cJSON_strdup(string); // 修改键名
+	if (!(item->type & cJSON_StringIsConst) && item->string) // item的键名不为空且不是常量，则释放item的string
+		mem_free(cJSON_ALLOC(object), item->string);
+	item->string = cJSON_strdup(string, cJSON_ALLOC(object)); // 修改键名
+	item->type &= ~cJSON_StringIsConst;	 // 新键名由cJSON持有
 	cJSON_AddItemToArray(object, item);	 // 把item添加到object
 }
 void cJSON_AddItemToObjectCS(cJSON *object, const char *string, cJSON *item) // mark:6
@@ -1211,49 +3597,51 @@ void cJSON_AddItemToObjectCS(cJSON *object, const char *string, cJSON *item) //
 	if (!item)
 		return;
 	if (!(item->type & cJSON_StringIsConst) && item->string)
-		cJSON_free(item->string);
+		mem_free(cJSON_ALLOC(object), item->string);
 	item->string = (char *)string;
 	item->type |= cJSON_StringIsConst;
 	cJSON_AddItemToArray(object, item);
 }
-void cJSON_AddItemReferenceToArray(cJSON *array, cJSON *item) { cJSON_AddItemToArray(array, create_reference(item)); }								   // mark:7
-void cJSON_AddItemReferenceToObject(cJSON *object, const char *string, cJSON *item) { cJSON_AddItemToObject(object, string, create_reference(item)); } // mark:8
+void cJSON_AddItemReferenceToArray(cJSON *array, cJSON *item) { cJSON_AddItemToArray(array, create_reference(item, array)); }								   // mark:7
+void cJSON_AddItemReferenceToObject(cJSON *object, const char *string, cJSON *item) { cJSON_AddItemToObject(object, string, create_reference(item, object)); } // mark:8
 
-cJSON *cJSON_DetachItemFromArray(cJSON *array, int which) // mark:9
+/* 把已定位的成员c从parent中摘下，which是c的下标，未知时传-1 */
+static cJSON *detach_item(cJSON *parent, cJSON *c, int which)
 {
-	cJSON *c = array->child;
-	while (c && which > 0)
-		c = c->next, which--;
-	if (!c)
-		return 0;
-	if (c->prev)
+	if (c != parent->child) // 首元素的prev是尾元素，不能按prev是否为空判断
 		c->prev->next = c->next;
 	if (c->next)
-		c->next->prev = c->prev;
-	if (c == array->child)
-		array->child = c->next;
+		c->next->prev = c->prev; // 摘下首元素时，新首元素的prev正好接过尾指针
+	else if (c != parent->child)
+		parent->child->prev = c->prev; // 摘下尾元素，更新尾指针
+	if (c == parent->child)
+		parent->child = c->next;
 	c->prev = c->next = 0;
+	hash_remove(parent, c);
+	vector_remove(parent, which, c);
 	return c;
 }
-void cJSON_DeleteItemFromArray(cJSON *array, int which) { cJSON_Delete(cJSON_DetachItemFromArray(array, which)); } // mark:10
+cJSON *cJSON_DetachItemFromArray(cJSON *array, int which) // mark:9
+{
+	cJSON *c = cJSON_GetArrayItem(array, which); // 大数组走向量
+	if (!c)
+		return 0;
+	return detach_item(array, c, which < 0 ? 0 : which);
+}
+void cJSON_DeleteItemFromArray(cJSON *array, int which) { cJSON_DeleteWithAllocator(cJSON_DetachItemFromArray(array, which), array ? cJSON_ALLOC(array) : 0); } // mark:10
 cJSON *cJSON_DetachItemFromObject(cJSON *object, const char *string)											   // mark:11
 {
-	int i = 0;
-	cJSON *c = object->child;
-	while (c && cJSON_strcasecmp(c->string, string))
-		i++, c = c->next;
+	cJSON *c = cJSON_GetObjectItem(object, string); // 宽对象走哈希索引
 	if (c)
-		return cJSON_DetachItemFromArray(object, i);
+		return detach_item(object, c, -1);
 	return 0;
 }
-void cJSON_DeleteItemFromObject(cJSON *object, const char *string) { cJSON_Delete(cJSON_DetachItemFromObject(object, string)); } // mark:12
+void cJSON_DeleteItemFromObject(cJSON *object, const char *string) { cJSON_DeleteWithAllocator(cJSON_DetachItemFromObject(object, string), object ? cJSON_ALLOC(object) : 0); } // mark:12
 
 /* 用新项替换数组/对象里的旧项 */
 void cJSON_InsertItemInArray(cJSON *array, int which, cJSON *newitem) // mark:13
 {
-	cJSON *c = array->child;
-	while (c && which > 0)
-		c = c->next, which--;
+	cJSON *c = cJSON_GetArrayItem(array, which); // 大数组走向量
 	if (!c)
 	{
 		cJSON_AddItemToArray(array, newitem);
@@ -1266,98 +3654,182 @@ void cJSON_InsertItemInArray(cJSON *array, int which, cJSON *newitem) // mark:13
 		array->child = newitem;
 	else
 		newitem->prev->next = newitem;
+	hash_add(array, newitem);
+	vector_insert(array, which < 0 ? 0 : which, newitem);
 }
-void cJSON_ReplaceItemInArray(cJSON *array, int which, cJSON *newitem) // 替换数组元素
+/* 用newitem替换parent中已定位的成员c，并释放c，which是c的下标，未知时传-1 */
+static void replace_item(cJSON *parent, cJSON *c, cJSON *newitem, int which)
 {
-	cJSON *c = array->child; // 指向首元素
-	while (c && which > 0)	 // 遍历到指定位置，对应数组下标[which]的元素
-		c = c->next, which--;
-	if (!c) // which越界，则直接返回结束执行
-		return;
+	struct cJSON_Internal *index = cJSON_INDEX(parent);
+
 	newitem->next = c->next;		   // 连接后继
 	newitem->prev = c->prev;		   // 连接前驱
 	if (newitem->next)				   // 不是最后一个元素
 		newitem->next->prev = newitem; // 后继元素的前驱指向新元素
-	if (c == array->child)			   // 是第一个元素
-		array->child = newitem;		   // array->child指向新首元素
+	else if (c != parent->child)	   // 是最后一个元素
+		parent->child->prev = newitem; // 更新尾指针
+	else							   // 唯一的元素
+		newitem->prev = newitem;
+	if (c == parent->child)			   // 是第一个元素
+		parent->child = newitem;	   // parent->child指向新首元素
 	else							   // 不是第一个元素
 		newitem->prev->next = newitem; // 前驱元素的后继指向新元素
 	c->next = c->prev = 0;			   // 断开旧元素
-	cJSON_Delete(c);				   // 释放旧元素
+	hash_remove(parent, c);			   // 先出索引，释放后键名就没了
+	hash_add(parent, newitem);		   // 新元素入索引
+	if (index && index->items)		   // 向量中原位替换
+	{
+		if (which < 0)
+			for (which = 0; which < index->length && index->items[which] != c; which++)
+				;
+		if (which < index->length)
+			index->items[which] = newitem;
+	}
+	cJSON_DeleteWithAllocator(c, cJSON_ALLOC(parent)); // 释放旧元素
+}
+void cJSON_ReplaceItemInArray(cJSON *array, int which, cJSON *newitem) // 替换数组元素
+{
+	cJSON *c = cJSON_GetArrayItem(array, which); // 找到对应数组下标[which]的元素，大数组走向量
+	if (!c)										 // which越界，则直接返回结束执行
+		return;
+	replace_item(array, c, newitem, which < 0 ? 0 : which);
 }
 void cJSON_ReplaceItemInObject(cJSON *object, const char *string, cJSON *newitem) // 替换对象元素
 {
-	int i = 0;										 // 记录键名在object中的位置
-	cJSON *c = object->child;						 // 指向首元素
-	while (c && cJSON_strcasecmp(c->string, string)) // 键名不匹配，则继续遍历
-		i++, c = c->next;
-	if (c) // 非空说明还没找完，存在匹配的键值对
+	cJSON *c = cJSON_GetObjectItem(object, string); // 宽对象走哈希索引
+	if (c)											// 存在匹配的键值对
+	{
+		if (!(newitem->type & cJSON_StringIsConst) && newitem->string)
+			mem_free(cJSON_ALLOC(object), newitem->string);
+		newitem->string = cJSON_strdup(string, cJSON_ALLOC(object)); // 新项赋值键名
+		newitem->type &= ~cJSON_StringIsConst;
+		replace_item(object, c, newitem, -1); // 新项替换旧项
+	}
+}
+
+/* 从alloc创建基础类型的节点，type为cJSON_NULL、cJSON_False、cJSON_True、cJSON_Array或cJSON_Object */
+cJSON *cJSON_CreateWithAllocator(int type, const cJSON_Allocator *alloc)
+{
+	cJSON *item = cJSON_New_Item(alloc);
+	if (item)
+	{
+		item->type = type;
+		if (alloc && cJSON_CONTAINER(item) && !internal_new(item, alloc)) // 之后往这个容器里增删成员都用同一个分配器
+		{
+			mem_free(alloc, item);
+			return 0;
+		}
+	}
+	return item;
+}
+cJSON *cJSON_CreateNumberWithAllocator(double num, const cJSON_Allocator *alloc)
+{
+	cJSON *item = cJSON_New_Item(alloc);
+	if (item)
+	{
+		item->type = cJSON_Number;
+		cJSON_SetNumberHelper(item, num);
+	}
+	return item;
+}
+cJSON *cJSON_CreateStringWithAllocator(const char *string, const cJSON_Allocator *alloc)
+{
+	cJSON *item = cJSON_New_Item(alloc);
+	if (item)
 	{
-		newitem->string = cJSON_strdup(string);		  // 新项赋值键名
-		cJSON_ReplaceItemInArray(object, i, newitem); // 借用数组替换的方法新项替换旧项
+		item->type = cJSON_String;
+		if (!(item->valuestring = cJSON_strdup(string, alloc))) // 复制失败时不返回没有值的字符串节点
+		{
+			mem_free(alloc, item);
+			return 0;
+		}
 	}
+	return item;
 }
 
 /* 创建基础类型 */
 cJSON *cJSON_CreateNull(void) // cJSON创建null
 {
-	cJSON *item = cJSON_New_Item(); // 创建一个新项
+	cJSON *item = cJSON_New_Item(0); // 创建一个新项
 	if (item)						// 如果创建成功
 		item->type = cJSON_NULL;	// 设置为cJSON_NULL类型
 	return item;
 }
 cJSON *cJSON_CreateTrue(void) // cJSON创建true
 {
-	cJSON *item = cJSON_New_Item(); // 创建一个新项
+	cJSON *item = cJSON_New_Item(0); // 创建一个新项
 	if (item)						// 如果创建成功
 		item->type = cJSON_True;	// 设置为cJSON_True类型
 	return item;
 }
 cJSON *cJSON_CreateFalse(void) // cJSON创建false
 {
-	cJSON *item = cJSON_New_Item(); // 创建一个新项
+	cJSON *item = cJSON_New_Item(0); // 创建一个新项
 	if (item)						// 如果创建成功
 		item->type = cJSON_False;	// 设置为cJSON_False类型
 	return item;
 }
 cJSON *cJSON_CreateBool(int b) // cJSON创建bool
 {
-	cJSON *item = cJSON_New_Item();				   // 创建一个新项
+	cJSON *item = cJSON_New_Item(0);				   // 创建一个新项
 	if (item)									   // 如果创建成功
 		item->type = b ? cJSON_True : cJSON_False; // 根据bool值设置类型
 	return item;
 }
 cJSON *cJSON_CreateNumber(double num) // cJSON创建数字
 {
-	cJSON *item = cJSON_New_Item(); // 创建一个新项
+	cJSON *item = cJSON_New_Item(0); // 创建一个新项
 	if (item)						// 如果创建成功
 	{
-		item->type = cJSON_Number; // 设置类型为数字
-		item->valuedouble = num;   // 数字精确赋值
-		item->valueint = (int)num; // 数字整数赋值
+		item->type = cJSON_Number;	   // 设置类型为数字
+		cJSON_SetNumberHelper(item, num); // 同时填好valueint64和valueint
+	}
+	return item;
+}
+cJSON *cJSON_CreateInt64(long long num) // cJSON创建64位整数
+{
+	cJSON *item = cJSON_New_Item(0);
+	if (item)
+	{
+		item->type = cJSON_Number;
+		cJSON_SetInt64Helper(item, num); // valueint64保存精确值
 	}
 	return item;
 }
+double cJSON_SetNumberHelper(cJSON *object, double number)
+{
+	object->valuedouble = number;
+	object->valueint64 = double_to_int64(number);
+	object->valueint = int64_to_int(object->valueint64);
+	return number;
+}
+long long cJSON_SetInt64Helper(cJSON *object, long long number)
+{
+	object->valuedouble = (double)number;
+	object->valueint64 = number;
+	object->valueint = int64_to_int(number);
+	return number;
+}
 cJSON *cJSON_CreateString(const char *string) // cJSON创建字符串
 {
-	cJSON *item = cJSON_New_Item(); // 创建一个新项
+	cJSON *item = cJSON_New_Item(0); // 创建一个新项
 	if (item)						// 如果创建成功
 	{
 		item->type = cJSON_String;				  // 设置类型为字符串
-		item->valuestring = cJSON_strdup(string); // 字符串项赋值
+		item->valuestring = cJSON_strdup(string, 0); // 字符串项赋值
 	}
 	return item;
 }
 cJSON *cJSON_CreateArray(void) // cJSON创建数组
 {
-	cJSON *item = cJSON_New_Item(); // 创建一个新项
+	cJSON *item = cJSON_New_Item(0); // 创建一个新项
 	if (item)						// 如果创建成功
 		item->type = cJSON_Array;	// 设置类型为数组
 	return item;
 }
 cJSON *cJSON_CreateObject(void) // 构建cJSON对象
 {
-	cJSON *item = cJSON_New_Item(); // 创建一个新项
+	cJSON *item = cJSON_New_Item(0); // 创建一个新项
 	if (item)						// 如果创建成功
 		item->type = cJSON_Object;	// 设置类型为对象
 	return item;					// 返回指针
@@ -1377,6 +3849,8 @@ cJSON *cJSON_CreateIntArray(const int *numbers, int count) // 构建cJSON整型
 			suffix_object(p, n);			// 插入元素
 		p = n;								// 更新遍历指针
 	}
+	if (a && a->child)
+		a->child->prev = n; // 首元素的prev指向尾元素
 	return a;
 }
 cJSON *cJSON_CreateFloatArray(const float *numbers, int count) // mark:14
@@ -1392,6 +3866,8 @@ cJSON *cJSON_CreateFloatArray(const float *numbers, int count) // mark:14
 			suffix_object(p, n);
 		p = n;
 	}
+	if (a && a->child)
+		a->child->prev = n;
 	return a;
 }
 cJSON *cJSON_CreateDoubleArray(const double *numbers, int count) // mark:15
@@ -1407,6 +3883,8 @@ cJSON *cJSON_CreateDoubleArray(const double *numbers, int count) // mark:15
 			suffix_object(p, n);
 		p = n;
 	}
+	if (a && a->child)
+		a->child->prev = n;
 	return a;
 }
 cJSON *cJSON_CreateStringArray(const char **strings, int count) // 构建cJSON字符串数组
@@ -1422,68 +3900,117 @@ cJSON *cJSON_CreateStringArray(const char **strings, int count) // 构建cJSON
 			suffix_object(p, n);			// 连接元素
 		p = n;								// 遍历指针指向下一个元素
 	}
+	if (a && a->child)
+		a->child->prev = n; // 首元素的prev指向尾元素
 	return a;
 }
 
-/* Duplication */ // mark:16
-cJSON *cJSON_Duplicate(cJSON *item, int recurse)
+/* 复制一个节点本身，不含子节点 */
+static cJSON *duplicate_item(cJSON *item, int recurse, const cJSON_Allocator *a)
 {
-	cJSON *newitem, *cptr, *nptr = 0, *newchild;
-	/* Bail on bad ptr */
-	if (!item)
+	cJSON *newitem;
+	if (a && recurse && !lazy_expand(item)) // 副本不能留着未展开的容器，否则展开时会用全局分配器
 		return 0;
 	/* Create new item */
-	newitem = cJSON_New_Item();
+	newitem = cJSON_New_Item(a);
 	if (!newitem)
 		return 0;
 	/* Copy over all vars */
-	newitem->type = item->type & (~cJSON_IsReference), newitem->valueint = item->valueint, newitem->valuedouble = item->valuedouble;
-	if (item->valuestring)
+	newitem->type = item->type & (~(cJSON_IsReference | cJSON_StringIsConst | cJSON_InArena | cJSON_ArenaOwner | cJSON_InSitu)), newitem->valueint = item->valueint, newitem->valueint64 = item->valueint64;
+	if ((item->type & 255) == cJSON_Number)
+		newitem->valuedouble = item->valuedouble;
+	if (item->type & cJSON_Lazy) // 未展开的容器：递归复制时共用同一段输入，照样按需展开
 	{
-		newitem->valuestring = cJSON_strdup(item->valuestring);
-		if (!newitem->valuestring)
+		if (!recurse)
+			newitem->type &= ~cJSON_Lazy;
+		else if (internal_new(newitem, 0))
+			newitem->internal->span = item->internal->span, newitem->internal->spanlen = item->internal->spanlen;
+		else
 		{
 			cJSON_Delete(newitem);
 			return 0;
 		}
 	}
+	else if (cJSON_VALUESTRING(item))
+	{
+		newitem->valuestring = cJSON_strdup(item->valuestring, a);
+		if (!newitem->valuestring)
+		{
+			cJSON_DeleteWithAllocator(newitem, a);
+			return 0;
+		}
+	}
+	if (a && cJSON_CONTAINER(newitem) && !newitem->internal && !internal_new(newitem, a)) // 不沿用原容器记下的分配器
+	{
+		cJSON_DeleteWithAllocator(newitem, a);
+		return 0;
+	}
 	if (item->string)
 	{
-		newitem->string = cJSON_strdup(item->string);
+		newitem->string = cJSON_strdup(item->string, a);
 		if (!newitem->string)
 		{
-			cJSON_Delete(newitem);
+			cJSON_DeleteWithAllocator(newitem, a);
 			return 0;
 		}
 	}
+	return newitem;
+}
+
+/* Duplication */ // mark:16
+/*
+	递归复制时不递归调用，而是按先序逐个复制节点：有子节点时把原节点和副本成对压入显式栈，
+	接着复制第一个子节点；没有子节点时复制下一个兄弟，没有兄弟就出栈回到上一层。
+*/
+cJSON *cJSON_DuplicateWithAllocator(cJSON *item, int recurse, const cJSON_Allocator *alloc)
+{
+	walk_stack stack;
+	cJSON *newitem, *cptr, *nptr, *newchild;
+	int n = 0; // 副本所在容器已有的成员数，自动建向量用
+	/* Bail on bad ptr */
+	if (!item || !(newitem = duplicate_item(item, recurse, alloc)))
+		return 0;
 	/* If non-recursive, then we're done! */
 	if (!recurse)
 		return newitem;
-	/* Walk the ->next chain for the child. */
-	cptr = item->child;
-	while (cptr)
+	stack_init(&stack, alloc);
+	cptr = item, nptr = newitem; // nptr是cptr的副本
+	for (;;)
 	{
-		newchild = cJSON_Duplicate(cptr, 1); /* Duplicate (with recurse) each item in the ->next chain */
-		if (!newchild)
+		if (cptr->child) // 进入子节点链表
 		{
-			cJSON_Delete(newitem);
-			return 0;
+			if (stack.depth == 2 * cJSON_NESTING_LIMIT || !stack_push(&stack, cptr) || !stack_push(&stack, nptr) || !(newchild = duplicate_item(cptr->child, 1, alloc)))
+				break;
+			nptr->child = newchild;
+			cptr = cptr->child, nptr = newchild, n = 1;
+			continue;
 		}
-		if (nptr)
+		/* Walk the ->next chain; at its end, go back up one level. */
+		while (stack.depth && !cptr->next)
 		{
-			nptr->next = newchild, newchild->prev = nptr;
-			nptr = newchild;
-		} /* If newitem->child already set, then crosswire ->prev and ->next and move on */
-		else
+			newchild = stack.items[--stack.depth];
+			newchild->child->prev = nptr; // 首元素的prev指向尾元素
+			nptr = newchild, cptr = stack.items[--stack.depth];
+			n = stack.depth ? vector_count(stack.items[stack.depth - 1]) : 0;
+		}
+		if (!stack.depth) // 回到了item，复制完成
 		{
-			newitem->child = newchild;
-			nptr = newchild;
-		} /* Set newitem->child and move to it */
-		cptr = cptr->next;
+			stack_free(&stack);
+			return newitem;
+		}
+		if (!(newchild = duplicate_item(cptr->next, 1, alloc)))
+			break;
+		nptr->next = newchild, newchild->prev = nptr; /* crosswire ->prev and ->next and move on */
+		vector_track(stack.items[stack.depth - 1], newchild, ++n);
+		cptr = cptr->next, nptr = newchild;
 	}
-	return newitem;
+	stack_free(&stack);
+	cJSON_DeleteWithAllocator(newitem, alloc);
+	return 0;
 }
 
+cJSON *cJSON_Duplicate(cJSON *item, int recurse) { return cJSON_DuplicateWithAllocator(item, recurse, 0); }
+
 void cJSON_Minify(char *json) // mark:17
 {
 	char *into = json;
@@ -1,6 +1,9 @@
 #ifndef cJSON__h
 #define cJSON__h
 
+#include <stddef.h> /* size_t */
+#include <stdio.h>  /* FILE */
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -17,20 +20,45 @@ extern "C"
 
 #define cJSON_IsReference 256   // 表示引用类型
 #define cJSON_StringIsConst 512 // 表示字符串是const类型
+#define cJSON_InArena 1024      // 表示节点及其valuestring位于arena中，不单独释放
+#define cJSON_ArenaOwner 2048   // 表示该根节点独占所在的arena，删除根节点时整体释放arena
+#define cJSON_InSitu 4096       // 表示valuestring指向就地解析的输入缓冲区，不单独释放
+#define cJSON_Lazy 8192         // 表示数组/对象还未展开，成员仍是输入中的一段文本，child为空
 
   /* cJSON 结构体: */
   typedef struct cJSON
   {
-    struct cJSON *next, *prev; /* next/prev 用于遍历数组或对象链表中的同级元素. 或者, 使用 GetArraySize/GetArrayItem/GetObjectItem 函数进行操作. */
+    struct cJSON *next, *prev; /* next/prev 用于遍历数组或对象链表中的同级元素. 或者, 使用 GetArraySize/GetArrayItem/GetObjectItem 函数进行操作.
+                                  首元素的 prev 指向尾元素（尾元素的 next 仍为空），反向遍历时以回到首元素为终止条件. */
     struct cJSON *child;       /* 对于数组或对象项，会有一个 child 指针指向数组或对象中的子级元素。 */
 
-    int type; /* 表示节点类型，具体如上所述 */
+    int type;     /* 表示节点类型，具体如上所述 */
+    int valueint; /* 如果 type==cJSON_Number , 此项存储int值（超出范围时取边界值）。放在type旁边，两个int共用8字节，不留填充*/
+
+#ifdef cJSON_COMPACT
+    /*
+      紧凑布局（编译时定义 cJSON_COMPACT，需要C11匿名联合体）：valuestring和valuedouble分别只属于
+      字符串和数字，两者共用8字节，节点从72字节缩到64字节。只做了这一处合并，type和标记、短字符串都没有压缩。
+      省下的内存只在arena里看得到；glibc按80字节一档分配72和64字节的请求，逐个malloc的节点占用不变。
+      字段名不变，但只有与 type 对应的那个字段有意义，读之前要先看类型。
+    */
+    union
+    {
+      char *valuestring;  /* 如果 type==cJSON_String , 此项存储字符串*/
+      double valuedouble; /* 如果 type==cJSON_Number , 此项存储double值*/
+    };
+    long long valueint64; /* 如果 type==cJSON_Number , 此项存储64位整数值，int64范围内的整数是精确值*/
 
-    char *valuestring;  /* 如果 type==cJSON_String , 此项存储字符串*/
-    int valueint;       /* 如果 type==cJSON_Number , 此项存储int值*/
-    double valuedouble; /* 如果 type==cJSON_Number , 此项存储double值*/
+    char *string; /* 用于存储对象的键名 */
+    struct cJSON_Internal *internal; /* 内部使用：数组/对象的分配器、查找索引和未展开时的输入范围，不要读写；自己填写的节点要置0 */
+#else
+    char *valuestring;    /* 如果 type==cJSON_String , 此项存储字符串*/
+    long long valueint64; /* 如果 type==cJSON_Number , 此项存储64位整数值，int64范围内的整数是精确值*/
+    double valuedouble;   /* 如果 type==cJSON_Number , 此项存储double值*/
 
     char *string; /* 用于存储对象的键名 */
+    struct cJSON_Internal *internal; /* 内部使用：数组/对象的分配器、查找索引和未展开时的输入范围，不要读写；自己填写的节点要置0 */
+#endif
   } cJSON;
 
   typedef struct cJSON_Hooks
@@ -41,15 +69,58 @@ extern "C"
 
   /* Supply malloc, realloc and free functions to cJSON */
   extern void cJSON_InitHooks(cJSON_Hooks *hooks);
+  /* Supply a realloc matching the cJSON_InitHooks malloc and free, so output buffers can grow in place; 0 removes it. Call it after cJSON_InitHooks,
+  which keeps libc realloc only when malloc and free are the libc ones and otherwise leaves none, so buffers grow by malloc, copy and free. */
+  extern void cJSON_InitReallocHook(void *(*realloc_fn)(void *ptr, size_t sz));
+
+  /* An allocator passed per call rather than set process-wide by cJSON_InitHooks, e.g. one memory pool per worker thread, or memory accounting per tenant.
+  Every function receives ctx. realloc_fn may be 0, in which case buffers grow by malloc, copy and free. The *WithAllocator calls below take a pointer to one; 0 selects the cJSON_InitHooks allocator.
+  Arrays and objects remember the allocator they were created with, which must outlive them. cJSON_Delete, AddItemToObject, ReplaceItemIn*, DeleteItemFrom*,
+  the references and the lookup indexes all use the allocator of the container involved, so the plain calls work on allocator trees.
+  Items added to a container must come from its allocator. A string, number or literal that is not in a container is freed with cJSON_DeleteWithAllocator.
+  Lazily parsed trees always use the cJSON_InitHooks allocator. */
+  typedef struct cJSON_Allocator
+  {
+    void *(*malloc_fn)(void *ctx, size_t sz);
+    void (*free_fn)(void *ctx, void *ptr);
+    void *(*realloc_fn)(void *ctx, void *ptr, size_t sz);
+    void *ctx;
+  } cJSON_Allocator;
+
+  /* arena（bump 分配器）: 整个文档的节点和字符串都从大块内存中切分，按块整体释放。 */
+  typedef struct cJSON_Arena cJSON_Arena;
+
+  /* Create an arena that hands out memory from chunks of chunk_size bytes (0 picks a default). Chunks are obtained through the cJSON_Hooks allocator. */
+  extern cJSON_Arena *cJSON_CreateArena(size_t chunk_size);
+  /* Release all chunks of the arena at once. Every tree parsed into it becomes invalid; heap items attached to such trees and lookup indexes built on them are released by cJSON_Delete on the root, so call that first. */
+  extern void cJSON_DeleteArena(cJSON_Arena *arena);
+  /* Parse a block of JSON into arena. If arena is 0, a private arena is created and owned by the returned root, so cJSON_Delete(root) frees the whole document chunk by chunk.
+  With a caller supplied arena, cJSON_Delete only releases heap items attached later; the document itself lives until cJSON_DeleteArena. */
+  extern cJSON *cJSON_ParseInArena(const char *value, cJSON_Arena *arena);
 
   /* Supply a block of JSON, and this returns a cJSON object you can interrogate. Call cJSON_Delete when finished. */
   extern cJSON *cJSON_Parse(const char *value);
-  /* Render a cJSON entity to text for transfer/storage. Free the char* when finished. */
+  /* Render a cJSON entity to text for transfer/storage. Free the char* when finished.
+  Print and PrintUnformatted render into one buffer that grows as needed. When the allocator has no realloc, they first walk the tree to estimate the output size, so the buffer is rarely copied. */
   extern char *cJSON_Print(cJSON *item);
   /* Render a cJSON entity to text for transfer/storage without any formatting. Free the char* when finished. */
   extern char *cJSON_PrintUnformatted(cJSON *item);
   /* Render a cJSON entity to text using a buffered strategy. prebuffer is a guess at the final size. guessing well reduces reallocation. fmt=0 gives unformatted, =1 gives formatted */
   extern char *cJSON_PrintBuffered(cJSON *item, int prebuffer, int fmt);
+  /* Exact length of the text Print (fmt=1) or PrintUnformatted (fmt=0) would produce, not counting the terminating '\0'; 0 if printing would fail. */
+  extern size_t cJSON_PrintedLength(cJSON *item, int fmt);
+  /* Render into a caller-provided buffer of length bytes, which is never grown or reallocated (only trees nested deeper than 32 levels allocate,
+  for the walk stack); cJSON_PrintedLength(item, fmt) + 1 bytes always suffice.
+  Returns 1 on success, 0 if the text (with its '\0') does not fit, leaving the buffer holding a truncated prefix. */
+  extern int cJSON_PrintPreallocated(cJSON *item, char *buffer, size_t length, int fmt);
+  /* Streaming output: write receives the text in pieces of up to chunk_size bytes (0 picks a default) and returns nonzero on success.
+  Memory use stays at one chunk however large the document is; the chunk only grows when a single value, such as a long string, does not fit in it. Returns 1 on success, 0 if memory ran out or write failed; the text already written is then incomplete. */
+  typedef int (*cJSON_WriteFn)(void *ctx, const char *buf, size_t len);
+  extern int cJSON_PrintStream(cJSON *item, int chunk_size, int fmt, cJSON_WriteFn write, void *ctx);
+  /* PrintStream helpers for a stdio stream and a raw file descriptor (partial writes and EINTR are retried). */
+  extern int cJSON_PrintToFile(cJSON *item, int fmt, FILE *fp);
+  extern int cJSON_PrintToFd(cJSON *item, int fmt, int fd);
+  /* The Print calls fail (return 0) on trees nested deeper than cJSON_NESTING_LIMIT, which also stops them on reference cycles. */
   /* Delete a cJSON entity and all subentities. */
   extern void cJSON_Delete(cJSON *c);
 
@@ -59,16 +130,61 @@ extern "C"
   extern cJSON *cJSON_GetArrayItem(cJSON *array, int item);
   /* Get item "string" from object. Case insensitive. */
   extern cJSON *cJSON_GetObjectItem(cJSON *object, const char *string);
+  /* Same as cJSON_GetObjectItem, but keys must match exactly. */
+  extern cJSON *cJSON_GetObjectItemCaseSensitive(cJSON *object, const char *string);
+  /* Arrays with at least 32 members get the pointer vector below on their own when they are parsed, duplicated or grown by AddItemToArray,
+  so a GetArraySize/GetArrayItem loop over them is linear; smaller arrays and objects are walked unless indexed here. The vector costs 8 bytes per member;
+  compile cJSON.c with -DcJSON_VECTOR_THRESHOLD=n to change the 32, or with 0 to build vectors only here.
+  Index the array or object item: a pointer vector with a cached size makes GetArraySize and GetArrayItem O(1), and for objects a key hash index
+  lets GetObjectItem(CaseSensitive) skip the member scan. With recurse, also every array and object below item that has at least 8 members (lazy containers are expanded on the way).
+  Returns 0 if memory ran out; the getters still work, falling back to walking the members. Indexes are kept in sync by the Add/Detach/Insert/Replace calls.
+  The getters never build an index or otherwise change the tree (apart from expanding lazy containers), so after BuildIndex any number of threads may read one tree at once;
+  BuildIndex itself, like every Add/Detach/Insert/Replace/Delete call, needs the tree to itself. */
+  extern int cJSON_BuildIndex(cJSON *item, int recurse);
+  /* If you edit ->child, ->next or ->string by hand, call this on the container afterwards to drop its index (call cJSON_BuildIndex again to rebuild it). */
+  extern void cJSON_ResetIndex(cJSON *item);
 
-  /* For analysing failed parses. This returns a pointer to the parse error. You'll probably need to look a few chars back to make sense of it. Defined when cJSON_Parse() returns 0. 0 when cJSON_Parse() succeeds. */
+  /* For analysing failed parses. This returns a pointer to the parse error. You'll probably need to look a few chars back to make sense of it. Defined when cJSON_Parse() returns 0. 0 when cJSON_Parse() succeeds.
+  The pointer is kept per thread (where the compiler supports thread-local storage); cJSON_ParseWithError reports errors without touching it. */
   extern const char *cJSON_GetErrorPtr(void);
 
+/* 解析错误类型: */
+#define cJSON_ErrorNone 0      // 没有出错
+#define cJSON_ErrorMemory 1    // 内存分配失败，没有出错位置
+#define cJSON_ErrorValue 2     // 此处不是合法的值（包括输入为空）
+#define cJSON_ErrorKey 3       // 对象成员缺少字符串键名
+#define cJSON_ErrorColon 4     // 键名后缺少冒号
+#define cJSON_ErrorArrayEnd 5  // 数组元素后既不是逗号也不是']'
+#define cJSON_ErrorObjectEnd 6 // 对象成员后既不是逗号也不是'}'
+#define cJSON_ErrorTrailing 7  // 要求以'\0'结尾时，值后面还有多余的字符
+#define cJSON_ErrorAborted 8   // SAX回调返回0，解析提前结束
+#define cJSON_ErrorDepth 9     // 数组和对象的嵌套超过cJSON_NESTING_LIMIT层
+
+/* 数组和对象最多嵌套的层数。解析、渲染、复制和删除都用显式栈而不是递归，调用栈的用量与嵌套深度无关，这个限制只用来尽早拒绝恶意的深层输入。
+   编译cJSON.c时用 -DcJSON_NESTING_LIMIT=n 修改。 */
+#ifndef cJSON_NESTING_LIMIT
+#define cJSON_NESTING_LIMIT 1000
+#endif
+
+  /* 一次解析的错误信息，由调用者提供，解析函数只写这一处 */
+  typedef struct cJSON_Error
+  {
+    int kind;             /* cJSON_Error* 之一 */
+    const char *position; /* 指向输入中出错的字符，没有位置时为0 */
+    size_t offset;        /* 出错位置相对输入起点的字节偏移 */
+    int line, column;     /* 出错位置的行号和列号（按字节计），都从1开始；没有位置时为0 */
+  } cJSON_Error;
+
+  /* Re-entrant ParseWithOpts: no shared state is read or written, so any number of threads may parse at once. error (may be 0) receives the outcome of this call, kind == cJSON_ErrorNone on success. */
+  extern cJSON *cJSON_ParseWithError(const char *value, const char **return_parse_end, int require_null_terminated, cJSON_Error *error);
+
   /* These calls create a cJSON item of the appropriate type. */
   extern cJSON *cJSON_CreateNull(void);
   extern cJSON *cJSON_CreateTrue(void);
   extern cJSON *cJSON_CreateFalse(void);
   extern cJSON *cJSON_CreateBool(int b);
   extern cJSON *cJSON_CreateNumber(double num);
+  extern cJSON *cJSON_CreateInt64(long long num); /* valueint64 keeps num exactly, valuedouble gets the nearest double. */
   extern cJSON *cJSON_CreateString(const char *string);
   extern cJSON *cJSON_CreateArray(void);
   extern cJSON *cJSON_CreateObject(void);
@@ -79,7 +195,7 @@ extern "C"
   extern cJSON *cJSON_CreateDoubleArray(const double *numbers, int count);
   extern cJSON *cJSON_CreateStringArray(const char **strings, int count);
 
-  /* Append item to the specified array/object. */
+  /* Append item to the specified array/object. item always passes to the container: if a lazily parsed container cannot be expanded (syntax error or out of memory), item is deleted instead. */
   extern void cJSON_AddItemToArray(cJSON *array, cJSON *item);
   extern void cJSON_AddItemToObject(cJSON *object, const char *string, cJSON *item);
   extern void cJSON_AddItemToObjectCS(cJSON *object, const char *string, cJSON *item); /* Use this when string is definitely const (i.e. a literal, or as good as), and will definitely survive the cJSON object */
@@ -95,6 +211,7 @@ extern "C"
 
   /* Update array items. */
   extern void cJSON_InsertItemInArray(cJSON *array, int which, cJSON *newitem); /* Shifts pre-existing items to the right. */
+  /* Replace and delete the member. When nothing is replaced (which out of range, string not found, or a lazy container that cannot be expanded), newitem stays with the caller. */
   extern void cJSON_ReplaceItemInArray(cJSON *array, int which, cJSON *newitem);
   extern void cJSON_ReplaceItemInObject(cJSON *object, const char *string, cJSON *newitem);
 
@@ -102,11 +219,83 @@ extern "C"
   extern cJSON *cJSON_Duplicate(cJSON *item, int recurse);
   /* Duplicate will create a new, identical cJSON item to the one you pass, in new memory that will
   need to be released. With recurse!=0, it will duplicate any children connected to the item.
-  The item->next and ->prev pointers are always zero on return from Duplicate. */
+  The item->next and ->prev pointers are always zero on return from Duplicate. With recurse, trees nested deeper than cJSON_NESTING_LIMIT are not copied (returns 0). */
 
   /* ParseWithOpts allows you to require (and check) that the JSON is null terminated, and to retrieve the pointer to the final byte parsed. */
   extern cJSON *cJSON_ParseWithOpts(const char *value, const char **return_parse_end, int require_null_terminated);
 
+  /* Parse exactly length bytes starting at value; no '\0' terminator is needed and nothing at or after value[length] is read, so recv buffers and mmap'd files can be parsed in place.
+  With require_null_terminated, only whitespace (or a '\0') may follow the value within the buffer. */
+  extern cJSON *cJSON_ParseWithLength(const char *value, size_t length);
+  /* Re-entrant like cJSON_ParseWithError: error (may be 0) receives the outcome and cJSON_GetErrorPtr is left alone. */
+  extern cJSON *cJSON_ParseWithLengthOpts(const char *value, size_t length, const char **return_parse_end, int require_null_terminated, cJSON_Error *error);
+  /* Per-call allocator variants (see cJSON_Allocator). Parse is cJSON_ParseWithLengthOpts with every item and string taken from alloc; the printed text comes from alloc and is released with its free_fn;
+  Duplicate expands lazy containers of item first, so the copy is entirely alloc's. Create takes cJSON_NULL, cJSON_False, cJSON_True, cJSON_Array or cJSON_Object. */
+  extern cJSON *cJSON_ParseWithAllocator(const char *value, size_t length, const char **return_parse_end, int require_null_terminated, cJSON_Error *error, const cJSON_Allocator *alloc);
+  extern char *cJSON_PrintWithAllocator(cJSON *item, int fmt, const cJSON_Allocator *alloc);
+  extern cJSON *cJSON_DuplicateWithAllocator(cJSON *item, int recurse, const cJSON_Allocator *alloc);
+  extern void cJSON_DeleteWithAllocator(cJSON *c, const cJSON_Allocator *alloc);
+  extern cJSON *cJSON_CreateWithAllocator(int type, const cJSON_Allocator *alloc);
+  extern cJSON *cJSON_CreateNumberWithAllocator(double num, const cJSON_Allocator *alloc);
+  extern cJSON *cJSON_CreateStringWithAllocator(const char *string, const cJSON_Allocator *alloc);
+  /* In-situ parsing of length bytes: strings are unescaped inside value itself and valuestring/string point into it (flagged cJSON_InSitu/cJSON_StringIsConst), so no string is allocated.
+  value is overwritten, even on failure, and must outlive the returned tree. A string missing its closing quote fails here, as there is no room left for its '\0'. */
+  extern cJSON *cJSON_ParseInSitu(char *value, size_t length);
+  extern cJSON *cJSON_ParseInSituOpts(char *value, size_t length, const char **return_parse_end, int require_null_terminated, cJSON_Error *error);
+  /* Lazy parsing of length bytes: arrays and objects are only scanned for their matching bracket and kept as spans of value (flagged cJSON_Lazy, child == 0).
+  A container's members are parsed, one level at a time, the first time GetArraySize/GetArrayItem/GetObjectItem/GetChild, the Add/Detach/Insert/Replace calls or Print reach it, so untouched subtrees cost neither time nor memory.
+  value must outlive the tree. Up front only unbalanced brackets and unterminated strings are detected; other syntax errors inside a container surface when it is expanded:
+  the lookup then returns 0 (Print fails) and cJSON_GetErrorPtr points at the error. Expansion changes the tree, so do not read one lazily parsed tree from several threads. */
+  extern cJSON *cJSON_ParseLazy(const char *value, size_t length);
+  extern cJSON *cJSON_ParseLazyOpts(const char *value, size_t length, const char **return_parse_end, int require_null_terminated, cJSON_Error *error);
+  /* item->child, after expanding item if it is still lazy; use it instead of ->child to walk a lazily parsed tree by hand. */
+  extern cJSON *cJSON_GetChild(cJSON *item);
+  /* Alternative two-stage engine for the same input and options as cJSON_ParseWithLength(Opts): a SIMD pass first indexes every quote and every bracket, colon and comma outside strings,
+  then the tree is built from that index. Trees, return_parse_end and errors are identical to the default engine (invalid input is re-parsed by it to report the error). Inputs of 2GB or more always use the default engine. */
+  extern cJSON *cJSON_ParseIndexed(const char *value, size_t length);
+  extern cJSON *cJSON_ParseIndexedOpts(const char *value, size_t length, const char **return_parse_end, int require_null_terminated, cJSON_Error *error);
+
+  /* Incremental (push) parsing for input that arrives in pieces, e.g. an HTTP body or a pipe. Chunks of any size may split strings, escapes, numbers and keywords anywhere;
+  the result and error positions are the same as cJSON_ParseWithLengthOpts on the concatenated input. */
+  typedef struct cJSON_Push cJSON_Push;
+  extern cJSON_Push *cJSON_PushCreate(int require_null_terminated);
+  /* Parse the next length bytes; chunk is not referenced after the call returns. Returns 0 once the input is known to be invalid (or memory ran out); call cJSON_PushFinish to learn why. */
+  extern int cJSON_PushFeed(cJSON_Push *push, const char *chunk, size_t length);
+  /* End of input: returns the tree (0 on failure) and releases push. error (may be 0) is filled in as by cJSON_ParseWithError, except that position is always 0. */
+  extern cJSON *cJSON_PushFinish(cJSON_Push *push, cJSON_Error *error);
+  /* Abandon a push parser without finishing it. */
+  extern void cJSON_PushDelete(cJSON_Push *push);
+
+  /* SAX解析的回调，都可以为0（忽略该事件）。返回0中止解析。
+  字符串和键名只在回调期间有效；number同时给出最接近的double和int64值（含义同valuedouble/valueint64）。 */
+  typedef struct cJSON_Sax
+  {
+    int (*start_object)(void *ctx);
+    int (*end_object)(void *ctx);
+    int (*start_array)(void *ctx);
+    int (*end_array)(void *ctx);
+    int (*key)(void *ctx, const char *key);
+    int (*string)(void *ctx, const char *value);
+    int (*number)(void *ctx, double valuedouble, long long valueint64);
+    int (*boolean)(void *ctx, int value);
+    int (*null)(void *ctx);
+  } cJSON_Sax;
+  /* Event-driven parsing of length bytes: no tree is built and nothing is allocated per value. Syntax checks and error positions match cJSON_ParseWithLengthOpts;
+  a callback returning 0 stops the parse with kind == cJSON_ErrorAborted at the value that raised it. Returns 1 if the whole input was accepted, 0 otherwise (see error, which may be 0). */
+  extern int cJSON_ParseSax(const char *value, size_t length, int require_null_terminated, const cJSON_Sax *sax, void *ctx, cJSON_Error *error);
+
+  /* JSON Lines (NDJSON) batch parsing: value holds one JSON text per line; empty lines are skipped and each record must be followed only by whitespace.
+  Records are parsed on threads worker threads, the caller included (threads <= 0 uses every online CPU; without pthreads, or built with cJSON_NO_THREADS, all run on the caller).
+  Any cJSON_InitHooks allocator must be thread-safe when threads != 1. */
+  /* Called once per record, from the worker that parsed it and in no particular order: index is the record's position among the non-empty lines, item (0 on failure) now belongs to the callback,
+  and error has offset from value and line set to the record's line. Return 0 to stop handing out further records. */
+  typedef int (*cJSON_LineFn)(void *ctx, size_t index, cJSON *item, const cJSON_Error *error);
+  /* Returns 0 if a callback stopped the batch (or memory ran out before parsing began), 1 otherwise; failed records do not change the result. */
+  extern int cJSON_ParseLinesEach(const char *value, size_t length, int threads, cJSON_LineFn fn, void *ctx);
+  /* Ordered results: an array of *count roots in input order, 0 for records that failed to parse (use cJSON_ParseLinesEach to learn why). Returns 0 if out of memory. Free with cJSON_DeleteLines. */
+  extern cJSON **cJSON_ParseLines(const char *value, size_t length, int threads, size_t *count);
+  extern void cJSON_DeleteLines(cJSON **items, size_t count);
+
   extern void cJSON_Minify(char *json);
 
 /* 快速创建事务的宏定义 */
@@ -117,9 +306,12 @@ extern "C"
 #define cJSON_AddNumberToObject(object, name, n) cJSON_AddItemToObject(object, name, cJSON_CreateNumber(n)) // 创建数值类型，改造成值为数值的键值对，加入对象
 #define cJSON_AddStringToObject(object, name, s) cJSON_AddItemToObject(object, name, cJSON_CreateString(s)) // 创建字符串类型，改造成值为字符串的键值对，加入对象
 
-/* When assigning an integer value, it needs to be propagated to valuedouble too. */
-#define cJSON_SetIntValue(object, val) ((object) ? (object)->valueint = (object)->valuedouble = (val) : (val))
-#define cJSON_SetNumberValue(object, val) ((object) ? (object)->valueint = (object)->valuedouble = (val) : (val))
+/* When assigning an integer value, it needs to be propagated to valuedouble too. Integers keep their exact value in valueint64. */
+#define cJSON_SetIntValue(object, val) ((object) ? cJSON_SetInt64Helper((object), (long long)(val)) : (val))
+#define cJSON_SetNumberValue(object, val) ((object) ? cJSON_SetNumberHelper((object), (double)(val)) : (val))
+  /* Helpers for the macros above: set valuedouble, valueint64 and valueint together (valueint saturates at INT_MIN/INT_MAX). */
+  extern double cJSON_SetNumberHelper(cJSON *object, double number);
+  extern long long cJSON_SetInt64Helper(cJSON *object, long long number);
 
 #ifdef __cplusplus
 }
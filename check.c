@@ -0,0 +1,788 @@
+/*
+	正确性检查，每项对应一项优化，全部通过时退出码为0。
+	编译：gcc -O2 check.c cJSON.c -lm -lpthread -o check
+	运行：./check                 跑全部检查
+	      ./check numbers ...     只跑列出的检查
+	随机输入由固定种子生成，每次运行都相同；失败时打印前几个出错的输入。
+*/
+#define _POSIX_C_SOURCE 200112L
+#include <float.h>
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cJSON.h"
+
+/* 固定种子的xorshift，生成的输入每次相同 */
+static unsigned long long rnd_state = 88172645463325252ull;
+static unsigned long long rnd64(void)
+{
+	rnd_state ^= rnd_state << 13;
+	rnd_state ^= rnd_state >> 7;
+	rnd_state ^= rnd_state << 17;
+	return rnd_state;
+}
+static unsigned rnd(unsigned n) { return (unsigned)(rnd64() % n); }
+
+static int fails; // 当前检查的失败次数
+
+/* 记一次失败，只打印前10条 */
+static void fail(const char *check, const char *input, const char *what)
+{
+	if (fails++ < 10)
+		printf("%-10s FAIL %s: [%.120s%s]\n", check, what, input, strlen(input) > 120 ? "..." : "");
+}
+
+/* 两个double的位模式相同（区分+0和-0） */
+static int same_bits(double a, double b) { return !memcmp(&a, &b, sizeof(double)); }
+
+/* user-007：cJSON解析的结果与strtod逐位相同 */
+static void number_vs_strtod(const char *s)
+{
+	cJSON *item = cJSON_Parse(s);
+	if (!item || item->type != cJSON_Number)
+		fail("numbers", s, "not parsed");
+	else if (!same_bits(item->valuedouble, strtod(s, 0)))
+		fail("numbers", s, "differs from strtod");
+	cJSON_Delete(item);
+}
+
+/* 随机的有效数字串：首位非零，共digits位，小数点在第point位之后（point从1开始，等于digits时没有小数点） */
+static char *put_digits(char *p, int digits, int point)
+{
+	int i;
+	for (i = 0; i < digits; i++)
+	{
+		if (i == point)
+			*p++ = '.';
+		*p++ = (char)('0' + (i ? rnd(10) : 1 + rnd(9)));
+	}
+	return p;
+}
+
+static void check_numbers(void)
+{
+	static const char *fixed[] = {
+		/* 正好在两个double正中间，按偶数舍入 */
+		"9007199254740993", "9007199254740995", "9007199254740993.0", "4503599627370496.5", "4503599627370497.5",
+		"1.00000000000000011102230246251565404236316680908203125", "1.00000000000000033306690738754696212708950042724609375",
+		/* 正中间之后还有非零位，超过19位有效数字，只有末尾几位决定舍入方向 */
+		"9007199254740993.000000000000000000001", "9007199254740992.999999999999999999999",
+		"1.00000000000000011102230246251565404236316680908203126", "1.00000000000000011102230246251565404236316680908203124",
+		"123456789012345678901234567890", "0.1000000000000000055511151231257827021181583404541015625",
+		"7.038531e-26", "1448997445238699", "1e23", "8.98846567431158e307", "2.2250738585072012e-308",
+		/* 次正规数 */
+		"4.9406564584124654e-324", "5e-324", "2.4703282292062327e-324", "2.4703282292062328e-324",
+		"2.2250738585072011e-308", "2.225073858507201e-308", "1e-310", "8.5e-323", "1.5e-323",
+		/* 接近上溢和下溢 */
+		"1.7976931348623157e308", "1.7976931348623158e308", "1.7976931348623159e308", "1.797693134862315807e308",
+		"1e308", "1e309", "1e400", "1e100000000", "1e-323", "1e-324", "3e-324", "1e-400", "1e-100000000",
+		"0.000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000001e-230",
+		"100000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000e215",
+		/* 整数快速路径的边界 */
+		"0", "-0", "0.0", "-0.0", "0e10", "9223372036854775807", "9223372036854775808", "-9223372036854775808",
+		"-9223372036854775809", "18446744073709551615", "18446744073709551616", "9999999999999999999", "10000000000000000000",
+	};
+	char buf[1024], *p;
+	int i, k;
+
+	for (i = 0; i < (int)(sizeof(fixed) / sizeof(fixed[0])); i++)
+		number_vs_strtod(fixed[i]);
+
+	for (i = 0; i < 200000; i++)
+	{
+		/* 随机位模式的有限double（包括次正规数），按最短到超长的各种精度写出 */
+		unsigned long long bits = rnd64();
+		double d;
+		if (rnd(8) == 0)
+			bits &= 0x800FFFFFFFFFFFFFull; // 次正规数
+		memcpy(&d, &bits, sizeof(d));
+		if (d != d || d - d != 0)
+			continue;
+		sprintf(buf, "%.17g", d);
+		number_vs_strtod(buf);
+		sprintf(buf, "%.*e", (int)rnd(40), d);
+		number_vs_strtod(buf);
+
+		/* 随机有效数字和指数，覆盖超过19位的输入和上溢、下溢附近 */
+		p = buf;
+		if (rnd(2))
+			*p++ = '-';
+		k = 1 + (int)rnd(rnd(4) ? 20 : 60);
+		p = put_digits(p, k, 1 + (int)rnd((unsigned)k));
+		sprintf(p, "e%d", (int)rnd(700) - 360);
+		number_vs_strtod(buf);
+	}
+
+#if LDBL_MANT_DIG >= 64
+	/* 两个相邻double的正中间：long double能精确表示，写出全部数字得到正好一半的输入，少写几位则落在一侧 */
+	for (i = 0; i < 20000; i++)
+	{
+		unsigned long long bits = rnd64() & 0x7FFFFFFFFFFFFFFFull;
+		double d, next;
+		long double mid;
+		if (rnd(4) == 0)
+			bits &= 0x000FFFFFFFFFFFFFull;
+		memcpy(&d, &bits, sizeof(d));
+		next = nextafter(d, INFINITY);
+		if (d != d || next - next != 0)
+			continue;
+		mid = ((long double)d + next) / 2;
+		sprintf(buf, "%.800Le", mid); // glibc写出精确的十进制值
+		number_vs_strtod(buf);
+		sprintf(buf, "%.*Le", 16 + (int)rnd(25), mid);
+		number_vs_strtod(buf);
+	}
+#endif
+}
+
+/*
+	输出是整数写法时，要么正好是double的精确值（%.0f写出全部数字），要么是最短形式补零（去掉末尾的0后不超过17位有效数字）。
+	超过17位又不是精确值的整数，说明输出的是另一个数，只是读回来碰巧舍入到同一个double
+*/
+static int integer_exact(const char *out, double d)
+{
+	char exact[400];
+	const char *p = out + (*out == '-');
+	size_t n = strlen(p);
+	if (!n || p[strspn(p, "0123456789")])
+		return 1; // 不是整数写法
+	sprintf(exact, "%.0f", fabs(d));
+	while (n > 1 && p[n - 1] == '0')
+		n--;
+	return !strcmp(p, exact) || n <= 17;
+}
+
+/* user-009：解析后再输出，超出int64的整数（饱和成LLONG_MAX）不能按valueint64输出 */
+static void print_parsed(const char *s)
+{
+	cJSON *item = cJSON_Parse(s);
+	char *out = item ? cJSON_PrintUnformatted(item) : 0;
+	if (!out)
+		fail("roundtrip", s, "not printed");
+	else if (!same_bits(strtod(out, 0), item->valuedouble))
+		fail("roundtrip", s, "printed a different double");
+	else if (!integer_exact(out, item->valuedouble))
+		fail("roundtrip", s, "printed an integer that is not the parsed value");
+	free(out);
+	cJSON_Delete(item);
+}
+
+/* user-008：Print再Parse得到逐位相同的double，输出交给strtod读回也相同 */
+static void roundtrip(double d)
+{
+	cJSON *item = cJSON_CreateNumber(d), *back;
+	char *out = cJSON_PrintUnformatted(item), bits[40];
+	sprintf(bits, "%a", d);
+	if (!out)
+		fail("roundtrip", bits, "not printed");
+	else if (!(back = cJSON_Parse(out)))
+		fail("roundtrip", out, "output not parsed");
+	else
+	{
+		if (!same_bits(back->valuedouble, d))
+			fail("roundtrip", out, "parsed back to a different double");
+		else if (!same_bits(strtod(out, 0), d))
+			fail("roundtrip", out, "strtod reads a different double");
+		else if (!integer_exact(out, d))
+			fail("roundtrip", out, "integer is not the exact value");
+		cJSON_Delete(back);
+	}
+	free(out);
+	cJSON_Delete(item);
+}
+
+static void check_roundtrip(void)
+{
+	static const double fixed[] = {0.0, -0.0, 1.0, -1.0, 0.1, 0.2, 0.3, 1.0 / 3, 2.0 / 3, 1e21, 1e22, 1e23, 123456789012345680.0,
+								   5e-324, 1e-323, 2.2250738585072009e-308, 2.2250738585072014e-308, 1.7976931348623157e308,
+								   9007199254740991.0, 9007199254740992.0, 9007199254740994.0, 9223372036854775807.0,
+								   -9223372036854775808.0, 9223372036854777856.0, -9223372036854777856.0, 18446744073709551616.0,
+								   1e-7, 1.5e-6, 123e-20, 4294967295.0, 4294967296.5};
+	/* int64边界附近：2^63、2^63+1和UINT64_MAX都舍入到int64范围外的double */
+	static const char *texts[] = {"9223372036854775807", "9223372036854775808", "9223372036854775809", "18446744073709551615",
+								  "-9223372036854775808", "-9223372036854775809", "9223372036854775296", "9223372036854774784"};
+	int i;
+	for (i = 0; i < (int)(sizeof(fixed) / sizeof(fixed[0])); i++)
+		roundtrip(fixed[i]);
+	for (i = 0; i < (int)(sizeof(texts) / sizeof(texts[0])); i++)
+		print_parsed(texts[i]);
+	for (i = 0; i < 1000000; i++)
+	{
+		unsigned long long bits = rnd64();
+		double d;
+		switch (i % 4)
+		{
+		case 1: // 次正规数
+			bits &= 0x800FFFFFFFFFFFFFull;
+			break;
+		case 2: // 常见数量级：指数在2^-40到2^40之间
+			bits = (bits & 0x800FFFFFFFFFFFFFull) | ((unsigned long long)(1023 - 40 + rnd(81)) << 52);
+			break;
+		case 3: // 整数和少数几位的小数
+			d = (double)(long long)(rnd64() >> rnd(64)) / (double)(1ull << rnd(12));
+			memcpy(&bits, &d, sizeof(d));
+			break;
+		}
+		memcpy(&d, &bits, sizeof(d));
+		if (d != d || d - d != 0)
+			continue;
+		roundtrip(d);
+	}
+}
+
+/* user-011：多个线程同时解析出错的输入，每个线程得到的错误类型、偏移、行号和列号都与单线程时相同 */
+typedef struct
+{
+	const char *text;
+	int kind;
+	size_t offset;
+	int line, column;
+} error_case;
+
+#define ERROR_CASES 512
+#define ERROR_THREADS 8
+static error_case error_cases[ERROR_CASES];
+static const char *error_what[ERROR_THREADS]; // 每个线程第一次出错的说明
+
+/* 按cJSON_Error的约定由偏移算出行号和列号，与解析器的实现无关 */
+static void line_column(const char *text, size_t offset, int *line, int *column)
+{
+	size_t i, start = 0;
+	*line = 1;
+	for (i = 0; i < offset; i++)
+		if (text[i] == '\n')
+			(*line)++, start = i + 1;
+	*column = (int)(offset - start) + 1;
+}
+
+/* 解析一条输入，与期望的结果不同时返回说明 */
+static const char *error_mismatch(const error_case *c)
+{
+	cJSON_Error e;
+	cJSON *root = cJSON_ParseWithError(c->text, 0, 1, &e);
+	cJSON_Delete(root);
+	if (e.kind != c->kind || (root != 0) != (c->kind == cJSON_ErrorNone))
+		return "wrong error kind";
+	if (c->kind != cJSON_ErrorNone && (e.position != c->text + c->offset || e.offset != c->offset || e.line != c->line || e.column != c->column))
+		return "wrong error position";
+	root = cJSON_Parse(c->text); // 旧接口的错误指针按线程保存，也不能被别的线程改掉
+	cJSON_Delete(root);
+	sched_yield(); // 让别的线程在读错误指针之前解析一次
+	if (c->kind != cJSON_ErrorNone && c->kind != cJSON_ErrorMemory && c->kind != cJSON_ErrorTrailing && cJSON_GetErrorPtr() != c->text + c->offset)
+		return "wrong cJSON_GetErrorPtr";
+	return 0;
+}
+
+static void *error_worker(void *arg)
+{
+	int id = (int)(size_t)arg, round, i;
+	for (round = 0; round < 40; round++)
+		for (i = 0; i < ERROR_CASES; i++)
+		{
+			const error_case *c = &error_cases[(i * 7 + id * 61 + round) % ERROR_CASES]; // 各线程错开顺序
+			if ((error_what[id] = error_mismatch(c)) != 0)
+				return (void *)c;
+		}
+	return 0;
+}
+
+static void check_threads(void)
+{
+	static const error_case fixed[] = {
+		{"", cJSON_ErrorValue, 0, 1, 1},
+		{"[1,2 x]", cJSON_ErrorArrayEnd, 5, 1, 6},
+		{"{\"a\" 1}", cJSON_ErrorColon, 5, 1, 6},
+		{"{1:2}", cJSON_ErrorKey, 1, 1, 2},
+		{"{\"a\":1 \"b\":2}", cJSON_ErrorObjectEnd, 7, 1, 8},
+		{"[1]x", cJSON_ErrorTrailing, 3, 1, 4},
+		{"[\n  1,\n  tru\n]", cJSON_ErrorValue, 9, 3, 3},
+		{"{\"a\":[1,{\"b\":}]}", cJSON_ErrorValue, 13, 1, 14},
+		{"[1,\n{\"k\":\"v\"}]", cJSON_ErrorNone, 0, 0, 0},
+	};
+	static const char bad[] = "x}]:,\"{[";
+	pthread_t th[ERROR_THREADS];
+	const char *what;
+	void *res;
+	cJSON *doc, *rec;
+	char *text, *s;
+	int i, n;
+
+	for (i = 0; i < (int)(sizeof(fixed) / sizeof(fixed[0])); i++)
+		if ((what = error_mismatch(&fixed[i])) != 0)
+			fail("threads", fixed[i].text, what);
+
+	/* 一篇多行的文档，每条输入在随机位置换进一个破坏语法的字符；期望结果由单线程解析得到，行列号另外由偏移算出核对 */
+	doc = cJSON_CreateArray();
+	for (i = 0; i < 20; i++)
+	{
+		rec = cJSON_CreateObject();
+		cJSON_AddItemToObject(rec, "id", cJSON_CreateNumber(i));
+		cJSON_AddItemToObject(rec, "name", cJSON_CreateString("item"));
+		cJSON_AddItemToObject(rec, "tags", cJSON_CreateStringArray((const char *[]){"a", "b"}, 2));
+		cJSON_AddItemToArray(doc, rec);
+	}
+	text = cJSON_Print(doc);
+	cJSON_Delete(doc);
+	n = (int)strlen(text);
+	for (i = 0; i < ERROR_CASES; i++)
+	{
+		error_case *c = &error_cases[i];
+		cJSON_Error e;
+		int line, column;
+		s = (char *)malloc(n + 1);
+		memcpy(s, text, n + 1);
+		if (i % 16) // 每16条留一条合法的输入
+			s[rnd((unsigned)n)] = bad[rnd(sizeof(bad) - 1)];
+		cJSON_Delete(cJSON_ParseWithError(s, 0, 1, &e));
+		c->text = s, c->kind = e.kind, c->offset = e.offset, c->line = e.line, c->column = e.column;
+		if (e.kind == cJSON_ErrorNone)
+			continue;
+		line_column(s, e.offset, &line, &column);
+		if (e.position != s + e.offset || line != e.line || column != e.column)
+			fail("threads", s, "line/column do not match the offset");
+	}
+	free(text);
+
+	for (i = 0; i < ERROR_THREADS; i++)
+		pthread_create(&th[i], 0, error_worker, (void *)(size_t)i);
+	for (i = 0; i < ERROR_THREADS; i++)
+		if (!pthread_join(th[i], &res) && res)
+			fail("threads", ((const error_case *)res)->text, error_what[i]);
+	for (i = 0; i < ERROR_CASES; i++)
+		free((char *)error_cases[i].text);
+}
+
+/* 计数分配器：fields检查核对分配和释放的次数 */
+static long count_live;
+static void *count_malloc(void *ctx, size_t sz)
+{
+	(void)ctx;
+	count_live++;
+	return malloc(sz);
+}
+static void count_free(void *ctx, void *ptr)
+{
+	(void)ctx;
+	if (ptr)
+		count_live--;
+	free(ptr);
+}
+
+/* user-002：容器的公开字段被改写后，索引、分配器和未展开的范围照常可用 */
+static void check_fields(void)
+{
+	static const char text[] = "{\"k0\":0,\"k1\":1,\"k2\":2,\"k3\":3,\"k4\":4,\"k5\":5,\"k6\":6,\"k7\":7,\"k8\":[1,2,{\"x\":9}],\"k9\":{\"y\":[]}}";
+	cJSON_Allocator counting = {count_malloc, count_free, 0, 0};
+	cJSON *doc, *copy, *lazy;
+	char *out;
+	int i;
+
+	doc = cJSON_ParseWithAllocator(text, sizeof(text) - 1, 0, 1, 0, &counting);
+	cJSON_BuildIndex(doc, 1);
+	cJSON_SetNumberValue(doc, 1.5);
+	cJSON_SetIntValue(cJSON_GetObjectItem(doc, "k8"), 7);
+	doc->valuestring = (char *)"x";
+	for (i = 0; i < 8; i++)
+	{
+		char key[4] = {'k', (char)('0' + i), 0};
+		if (!cJSON_GetObjectItem(doc, key) || cJSON_GetObjectItem(doc, key)->valueint != i)
+			fail("fields", text, "lookup after writing the value fields");
+	}
+	cJSON_AddItemToObject(doc, "new", cJSON_CreateWithAllocator(cJSON_Array, &counting));
+	cJSON_DeleteItemFromObject(doc, "k9");
+	copy = cJSON_DuplicateWithAllocator(doc, 1, &counting);
+	out = cJSON_PrintUnformatted(copy);
+	if (!out || strcmp(out, "{\"k0\":0,\"k1\":1,\"k2\":2,\"k3\":3,\"k4\":4,\"k5\":5,\"k6\":6,\"k7\":7,\"k8\":[1,2,{\"x\":9}],\"new\":[]}"))
+		fail("fields", out ? out : "", "duplicate after writing the value fields");
+	free(out);
+	cJSON_Delete(copy);
+	cJSON_Delete(doc);
+	if (count_live)
+		fail("fields", text, "allocator leaked or freed a block twice");
+
+	lazy = cJSON_ParseLazy(text, sizeof(text) - 1);
+	cJSON_SetNumberValue(cJSON_GetObjectItem(lazy, "k8"), 2.5);
+	if (cJSON_GetArraySize(cJSON_GetObjectItem(lazy, "k8")) != 3 || !cJSON_GetObjectItem(cJSON_GetArrayItem(cJSON_GetObjectItem(lazy, "k8"), 2), "x"))
+		fail("fields", text, "lazy container after writing the value fields");
+	cJSON_Delete(lazy);
+}
+
+/* 按下标取到的成员与沿链表数到的一致，数组大小也一致 */
+static void same_members(const char *how, cJSON *array)
+{
+	cJSON *c = cJSON_GetChild(array); // 未展开的容器先展开
+	int i = 0;
+	for (; c; c = c->next, i++)
+		if (cJSON_GetArrayItem(array, i) != c)
+			break;
+	if (c || !array || cJSON_GetArraySize(array) != i || cJSON_GetArrayItem(array, i))
+		fail("vector", how, "GetArrayItem/GetArraySize disagree with the member list");
+}
+
+/* user-003：自动建的成员向量，解析、懒解析、流式解析、复制和增删之后都与链表一致 */
+static void check_vector(void)
+{
+	char text[4096], *p = text;
+	cJSON *doc, *copy, *arr;
+	cJSON_Push *push;
+	int i;
+
+	p += sprintf(p, "[[1,2],");
+	for (i = 0; i < 200; i++)
+		p += sprintf(p, "%d,", i);
+	sprintf(p, "[3]]");
+
+	doc = cJSON_Parse(text);
+	same_members("parse", doc);
+	copy = cJSON_Duplicate(doc, 1);
+	same_members("duplicate", copy);
+	cJSON_InsertItemInArray(copy, 5, cJSON_CreateNull());
+	cJSON_Delete(cJSON_DetachItemFromArray(copy, 100));
+	cJSON_ReplaceItemInArray(copy, 7, cJSON_CreateTrue());
+	cJSON_AddItemToArray(copy, cJSON_CreateFalse());
+	same_members("insert/detach/replace/add", copy);
+	cJSON_Delete(copy);
+	cJSON_Delete(doc);
+
+	doc = cJSON_ParseLazy(text, strlen(text));
+	same_members("lazy", doc);
+	same_members("lazy inner", cJSON_GetArrayItem(doc, 0));
+	cJSON_Delete(doc);
+
+	push = cJSON_PushCreate(0);
+	for (i = 0; text[i]; i += 7)
+		cJSON_PushFeed(push, text + i, strlen(text + i) < 7 ? strlen(text + i) : 7);
+	doc = cJSON_PushFinish(push, 0);
+	same_members("push", doc);
+	cJSON_Delete(doc);
+
+	arr = cJSON_CreateArray();
+	for (i = 0; i < 100; i++)
+	{
+		cJSON_AddItemToArray(arr, cJSON_CreateNumber(i));
+		if (i % 10 == 0)
+			same_members("add", arr);
+	}
+	same_members("add", arr);
+	cJSON_Delete(arr);
+}
+
+/* 随机文档：嵌套的数组和对象，带转义和多字节字符的字符串，各种写法的数字，字面量，随机的空白和换行 */
+static char *gen_space(char *p)
+{
+	static const char ws[] = " \t\n\r";
+	while (!rnd(3))
+		*p++ = ws[rnd(4)];
+	return p;
+}
+static char *gen_string(char *p)
+{
+	static const char *parts[] = {"a", "key", "\\n", "\\\"", "\\\\", "\\/", "\\u00e9", "\\ud83d\\ude00", "\xc3\xa9", "\xe4\xb8\xad", " ", "0123456789abcdef"};
+	int n = (int)rnd(8);
+	*p++ = '"';
+	while (n--)
+		p += sprintf(p, "%s", parts[rnd(sizeof(parts) / sizeof(parts[0]))]);
+	*p++ = '"';
+	return p;
+}
+static char *gen_value(char *p, int depth)
+{
+	static const char *numbers[] = {"0", "-0", "7", "-12", "3.25", "1e5", "-2.5E-3", "123456789012345678901234", "9223372036854775807", "0.1", "1e400"};
+	static const char *words[] = {"true", "false", "null"};
+	int n, i, kind = (int)rnd(depth < 5 ? 6 : 3);
+	p = gen_space(p);
+	if (kind == 0)
+		p = gen_string(p);
+	else if (kind == 1)
+		p += sprintf(p, "%s", numbers[rnd(sizeof(numbers) / sizeof(numbers[0]))]);
+	else if (kind == 2)
+		p += sprintf(p, "%s", words[rnd(3)]);
+	else
+	{
+		int object = kind == 3;
+		*p++ = object ? '{' : '[';
+		p = gen_space(p);
+		n = (int)rnd(depth ? 6 : 40); // 根容器有时超过cJSON_VECTOR_THRESHOLD个成员
+		for (i = 0; i < n; i++)
+		{
+			if (i)
+				*p++ = ',';
+			if (object)
+			{
+				p = gen_string(gen_space(p));
+				p = gen_space(p);
+				*p++ = ':';
+			}
+			p = gen_space(gen_value(p, depth + 1));
+		}
+		*p++ = object ? '}' : ']';
+	}
+	return gen_space(p);
+}
+
+static char *copy_text(const char *s)
+{
+	char *t = (char *)malloc(strlen(s) + 1);
+	strcpy(t, s);
+	return t;
+}
+
+/* 各种解析方式共用的输入：合法的文档，以及截断、换进一个破坏语法的字符、后面接着多余内容的版本 */
+#define CORPUS_DOCS 200
+static char *corpus[CORPUS_DOCS * 4];
+static int corpus_count;
+static void make_corpus(void)
+{
+	static const char bad[] = "x}]:,\"{[\\";
+	char *buf, *s;
+	size_t n;
+	int i;
+	if (corpus_count)
+		return;
+	rnd_state = 0x9e3779b97f4a7c15ull; // 只跑其中一项检查时输入也相同
+	buf = (char *)malloc(1 << 20);
+	for (i = 0; i < CORPUS_DOCS; i++)
+	{
+		n = (size_t)(gen_value(buf, 0) - buf);
+		buf[n] = 0;
+		corpus[corpus_count++] = copy_text(buf);
+		s = copy_text(buf); // 截断
+		s[rnd((unsigned)n + 1)] = 0;
+		corpus[corpus_count++] = s;
+		s = copy_text(buf);
+		s[rnd((unsigned)n)] = bad[rnd(sizeof(bad) - 1)];
+		corpus[corpus_count++] = s;
+		s = (char *)malloc(n + 8);
+		sprintf(s, "%s %s", buf, rnd(2) ? "1" : "[]");
+		corpus[corpus_count++] = s;
+	}
+	free(buf);
+}
+
+/* 两棵树相同：类型、键名和值都一致，未展开的容器先展开 */
+static int same_tree(cJSON *a, cJSON *b)
+{
+	cJSON *x, *y;
+	if (!a || !b)
+		return a == b;
+	if ((a->type & 255) != (b->type & 255) || (!a->string != !b->string) || (a->string && strcmp(a->string, b->string)))
+		return 0;
+	switch (a->type & 255)
+	{
+	case cJSON_Number:
+		return same_bits(a->valuedouble, b->valuedouble) && a->valueint64 == b->valueint64 && a->valueint == b->valueint;
+	case cJSON_String:
+		return !strcmp(a->valuestring, b->valuestring);
+	case cJSON_Array:
+	case cJSON_Object:
+		for (x = cJSON_GetChild(a), y = cJSON_GetChild(b); x && y; x = x->next, y = y->next)
+			if (!same_tree(x, y))
+				return 0;
+		return !x && !y;
+	}
+	return 1;
+}
+
+/* 两次解析的错误相同（位置除外，流式解析没有输入指针） */
+static int same_error(const cJSON_Error *a, const cJSON_Error *b)
+{
+	return a->kind == b->kind && a->offset == b->offset && a->line == b->line && a->column == b->column;
+}
+
+/* user-015：按1到PUSH_CHUNKS字节和整段分块流式解析，得到的树和错误都与一次性解析相同 */
+#define PUSH_CHUNKS 16
+static void check_push(void)
+{
+	cJSON_Error want, got;
+	cJSON_Push *push;
+	cJSON *ref, *root;
+	size_t n, at, k;
+	int i, chunk, require;
+
+	make_corpus();
+	for (i = 0; i < corpus_count; i++)
+		for (require = 0; require < 2; require++)
+		{
+			n = strlen(corpus[i]);
+			ref = cJSON_ParseWithLengthOpts(corpus[i], n, 0, require, &want);
+			for (chunk = 1; chunk <= PUSH_CHUNKS + 1; chunk++)
+			{
+				k = (chunk > PUSH_CHUNKS) ? n : (size_t)chunk; // 最后一轮整段一次喂入
+				push = cJSON_PushCreate(require);
+				for (at = 0; at < n; at += k)
+					cJSON_PushFeed(push, corpus[i] + at, (n - at < k) ? n - at : k);
+				root = cJSON_PushFinish(push, &got);
+				if (!same_tree(ref, root))
+					fail("push", corpus[i], "tree differs from one-shot parsing");
+				else if (!same_error(&want, &got))
+					fail("push", corpus[i], "error differs from one-shot parsing");
+				cJSON_Delete(root);
+			}
+			cJSON_Delete(ref);
+		}
+}
+
+/* user-018：懒解析的树全部展开后与一次性解析相同；输入有错时，要么当场失败，要么展开到出错的容器时打印失败 */
+static void check_lazy(void)
+{
+	const char *want_end, *got_end;
+	cJSON *ref, *lazy;
+	char *out;
+	size_t n;
+	int i, require;
+
+	make_corpus();
+	for (i = 0; i < corpus_count; i++)
+		for (require = 0; require < 2; require++)
+		{
+			n = strlen(corpus[i]);
+			ref = cJSON_ParseWithLengthOpts(corpus[i], n, &want_end, require, 0);
+			lazy = cJSON_ParseLazyOpts(corpus[i], n, &got_end, require, 0);
+			if (ref && !lazy)
+				fail("lazy", corpus[i], "rejects a valid input");
+			else if (ref && got_end != want_end)
+				fail("lazy", corpus[i], "return_parse_end differs");
+			else if (ref && !same_tree(ref, lazy))
+				fail("lazy", corpus[i], "tree differs from one-shot parsing");
+			else if (!ref && lazy)
+			{
+				out = cJSON_PrintUnformatted(lazy); // 打印会展开所有容器，语法错误在这里出现
+				if (out)
+					fail("lazy", corpus[i], "accepts an invalid input");
+				free(out);
+			}
+			cJSON_Delete(ref);
+			cJSON_Delete(lazy);
+		}
+}
+
+/* 双阶段解析的一条输入：树、return_parse_end和错误（包括出错指针）都与默认引擎相同 */
+static void indexed_vs_default(const char *text, size_t n, int require)
+{
+	const char *want_end = 0, *got_end = 0;
+	cJSON_Error want, got;
+	cJSON *ref = cJSON_ParseWithLengthOpts(text, n, &want_end, require, &want);
+	cJSON *root = cJSON_ParseIndexedOpts(text, n, &got_end, require, &got);
+	if (!same_tree(ref, root))
+		fail("indexed", text, "tree differs from the default engine");
+	else if (got_end != want_end)
+		fail("indexed", text, "return_parse_end differs");
+	else if (!same_error(&want, &got) || want.position != got.position)
+		fail("indexed", text, "error differs from the default engine");
+	cJSON_Delete(ref);
+	cJSON_Delete(root);
+}
+
+/* user-019：双阶段解析与默认引擎逐项相同，另外让引号、反斜杠和括号依次落在64字节块的每个位置上 */
+static void check_indexed(void)
+{
+	static const char *tails[] = {"[\"a\\\\\\\\\",\"b\\\"c\",\"{[,:]}\"]", "{\"k\\\\\":[1,{\"\\\"\":2}]}", "[\"\\\\\\\"]", "[1,2,\"x"};
+	char text[256];
+	size_t n;
+	int i, k, require;
+
+	make_corpus();
+	for (i = 0; i < corpus_count; i++)
+		for (require = 0; require < 2; require++)
+			indexed_vs_default(corpus[i], strlen(corpus[i]), require);
+	for (i = 0; i < (int)(sizeof(tails) / sizeof(tails[0])); i++)
+		for (k = 0; k < 130; k++)
+		{
+			n = (size_t)sprintf(text, "%*s%s", k, "", tails[i]);
+			indexed_vs_default(text, n, 1);
+		}
+}
+
+/* 一棵树按两种格式：PrintedLength等于打印结果的长度，PrintPreallocated在length+1字节时成功且内容相同，length字节时失败 */
+static void printed_length(const char *input, cJSON *item)
+{
+	char *text, *buf;
+	size_t n;
+	int fmt;
+	for (fmt = 0; fmt < 2; fmt++)
+	{
+		text = fmt ? cJSON_Print(item) : cJSON_PrintUnformatted(item);
+		n = cJSON_PrintedLength(item, fmt);
+		if (!text || n != strlen(text))
+		{
+			fail("printed", input, "PrintedLength differs from strlen(Print)");
+			free(text);
+			continue;
+		}
+		buf = (char *)malloc(n + 1); // 正好够用，越界由ASan发现
+		if (!cJSON_PrintPreallocated(item, buf, n + 1, fmt) || strcmp(buf, text))
+			fail("printed", input, "PrintPreallocated fails at length+1");
+		if (cJSON_PrintPreallocated(item, buf, n, fmt))
+			fail("printed", input, "PrintPreallocated succeeds at length");
+		free(buf);
+		free(text);
+	}
+}
+
+/* user-023：语料中合法的树和几棵专门构造的树，长度估计与实际输出一致 */
+static void check_printed(void)
+{
+	static const double numbers[] = {0.0, -0.0, 0.1, 1.0 / 3, -1e300, 5e-324, 1e21, 123456789.0, 9007199254740993.0, 9223372036854775808.0, -9223372036854775808.0};
+	static const char *strings[] = {"", "plain", "\x01\x1f control", "quote\" back\\ slash/", "tab\tnew\nline", "\xc3\xa9\xe4\xb8\xad\xf0\x9f\x98\x80"};
+	cJSON *root, *nums, *c;
+	int i;
+
+	make_corpus();
+	for (i = 0; i < corpus_count; i++)
+	{
+		if ((root = cJSON_ParseWithLength(corpus[i], strlen(corpus[i]))))
+			printed_length(corpus[i], root);
+		cJSON_Delete(root);
+	}
+
+	root = cJSON_CreateObject();
+	cJSON_AddItemToObject(root, "numbers", nums = cJSON_CreateArray());
+	for (i = 0; i < (int)(sizeof(numbers) / sizeof(numbers[0])); i++)
+		cJSON_AddItemToArray(nums, cJSON_CreateNumber(numbers[i]));
+	cJSON_AddItemToObject(root, "int64", cJSON_CreateInt64(-9223372036854775807ll - 1));
+	for (i = 0; i < (int)(sizeof(strings) / sizeof(strings[0])); i++)
+		cJSON_AddItemToObject(root, strings[i], cJSON_CreateString(strings[i]));
+	cJSON_AddItemToObject(root, "empty", cJSON_CreateObject());
+	cJSON_AddItemToObject(root, "none", cJSON_CreateArray());
+	for (c = root, i = 0; i < 40; i++) // 超过32层时渲染的栈要到堆上
+		cJSON_AddItemToArray(c, cJSON_CreateArray()), c = c->child->prev;
+	printed_length("constructed", root);
+	cJSON_Delete(root);
+}
+
+static const struct
+{
+	const char *name;
+	void (*run)(void);
+} checks[] = {
+	{"numbers", check_numbers},
+	{"roundtrip", check_roundtrip},
+	{"threads", check_threads},
+	{"fields", check_fields},
+	{"vector", check_vector},
+	{"push", check_push},
+	{"lazy", check_lazy},
+	{"indexed", check_indexed},
+	{"printed", check_printed},
+};
+#define NCHECKS ((int)(sizeof(checks) / sizeof(checks[0])))
+
+int main(int argc, const char *argv[])
+{
+	int i, j, bad = 0;
+	for (i = 0; i < NCHECKS; i++)
+	{
+		for (j = 1; j < argc && strcmp(argv[j], checks[i].name); j++)
+			;
+		if (argc > 1 && j == argc)
+			continue; // 命令行列出了检查项，但没有这一项
+		fails = 0;
+		checks[i].run();
+		printf("%-10s %s\n", checks[i].name, fails ? "FAILED" : "ok");
+		bad |= (fails != 0);
+	}
+	return bad;
+}